@@ -0,0 +1,134 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <algorithm>
+#include "profiler.h"
+
+Profiler &Profiler::instance() {
+    static Profiler profiler;
+    return profiler;
+}
+
+Profiler::Profiler() {
+    frequency=SDL_GetPerformanceFrequency();
+    if(frequency==0) {
+        frequency=1;
+    }
+    for(int i=0;i<PHASES;i++) {
+        started[i]=0;
+        current[i]=0;
+    }
+    frames=0;
+    frame_draws=0; frame_switches=0;
+    last_draws=0; last_switches=0;
+    last_texture=NULL;
+}
+
+void Profiler::beginFrame() {
+    for(int i=0;i<PHASES;i++) {
+        current[i]=0;
+    }
+    frame_draws=0;
+    frame_switches=0;
+    last_texture=NULL;
+    begin(FRAME);
+}
+
+void Profiler::endFrame() {
+    end(FRAME);
+    int slot=frames%HISTORY;
+    for(int i=0;i<PHASES;i++) {
+        samples[slot][i]=current[i];
+    }
+    draws[slot]=frame_draws;
+    switches[slot]=frame_switches;
+    last_draws=frame_draws;
+    last_switches=frame_switches;
+    frames++;
+}
+
+void Profiler::begin(int phase) {
+    started[phase]=SDL_GetPerformanceCounter();
+}
+
+void Profiler::end(int phase) {
+    current[phase]+=SDL_GetPerformanceCounter()-started[phase];
+}
+
+void Profiler::countDraw(SDL_Texture* texture) {
+    frame_draws++;
+    if(texture!=last_texture) {
+        frame_switches++;
+        last_texture=texture;
+    }
+}
+
+const char* Profiler::returnName(int phase) {
+    static const char* names[PHASES]={"picking","camera","events","simulation","map","windows","present","frame"};
+    return phase>=0 && phase<PHASES ? names[phase] : "";
+}
+
+double Profiler::returnMin(int phase) {
+    int count=returnFrames();
+    if(count==0) {
+        return 0;
+    }
+    Uint64 least=samples[0][phase];
+    for(int i=1;i<count;i++) {
+        least=std::min(least,samples[i][phase]);
+    }
+    return milliseconds(least);
+}
+
+double Profiler::returnAverage(int phase) {
+    int count=returnFrames();
+    if(count==0) {
+        return 0;
+    }
+    Uint64 total=0;
+    for(int i=0;i<count;i++) {
+        total+=samples[i][phase];
+    }
+    return milliseconds(total)/count;
+}
+
+double Profiler::returnP99(int phase) {
+    int count=returnFrames();
+    if(count==0) {
+        return 0;
+    }
+    std::vector<Uint64> sorted(count);
+    for(int i=0;i<count;i++) {
+        sorted[i]=samples[i][phase];
+    }
+    int rank=(count*99+99)/100-1; //nearest rank
+    std::nth_element(sorted.begin(),sorted.begin()+rank,sorted.end());
+    return milliseconds(sorted[rank]);
+}
+
+bool Profiler::dump(std::string path) {
+    std::ofstream csv(path.c_str());
+    if(!csv.good()) {
+        printf("Can't write %s.\n",path.c_str());
+        return false;
+    }
+    csv<<"frame";
+    for(int i=0;i<PHASES;i++) {
+        csv<<","<<returnName(i)<<"_ms";
+    }
+    csv<<",draws,switches\n";
+    //Oldest frame first
+    int count=returnFrames();
+    for(int n=frames-count;n<frames;n++) {
+        int slot=n%HISTORY;
+        csv<<n;
+        for(int i=0;i<PHASES;i++) {
+            csv<<","<<milliseconds(samples[slot][i]);
+        }
+        csv<<","<<draws[slot]<<","<<switches[slot]<<"\n";
+    }
+    printf("Wrote %d frames to %s\n",count,path.c_str());
+    return true;
+}
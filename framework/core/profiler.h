@@ -0,0 +1,57 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+//Frame profiler. Scoped markers time the phases of the main loop with the performance counter and the last
+//HISTORY frames are kept in a ring buffer, from which min/avg/p99 are taken for the overlay. Renderers report their
+//draw calls here so every frame also records how many draws and texture switches it made.
+
+class Profiler {
+public:
+    enum Phase {PICKING, CAMERA, EVENTS, SIMULATION, MAP, WINDOWS, PRESENT, FRAME, PHASES};
+    enum {HISTORY=240};
+
+    static Profiler &instance(); //The profiler of the main loop
+
+    //Constructors & Deconstructors
+    Profiler(); //Default Constructor
+
+    //Rendering & Events
+    void beginFrame(); //Starts timing a frame
+    void endFrame(); //Stores the frame in the ring buffer
+    void begin(int phase); //Starts timing a phase, a phase can run several times a frame
+    void end(int phase); //Stops timing a phase
+    void countDraw(SDL_Texture* texture); //Counts a draw call, and a texture switch when texture changed
+
+    //Accessors
+    static const char* returnName(int phase); //Name of a phase
+    int returnFrames() {return frames<HISTORY ? frames : HISTORY;} //Number of frames in the ring buffer
+    double returnMin(int phase); //Shortest time of a phase in milliseconds
+    double returnAverage(int phase); //Average time of a phase in milliseconds
+    double returnP99(int phase); //99th percentile time of a phase in milliseconds
+    int returnDraws() {return last_draws;} //Draw calls of the last frame
+    int returnSwitches() {return last_switches;} //Texture switches of the last frame
+    bool dump(std::string path); //Writes the ring buffer to a CSV file, one row per frame
+
+private:
+    double milliseconds(Uint64 ticks) {return ticks*1000.0/frequency;}
+
+    Uint64 frequency;
+    Uint64 started[PHASES]; //when each running phase began
+    Uint64 current[PHASES]; //time of each phase in the current frame
+    Uint64 samples[HISTORY][PHASES];
+    int draws[HISTORY], switches[HISTORY];
+    int frames; //frames recorded so far, the ring buffer position is frames%HISTORY
+    int frame_draws, frame_switches, last_draws, last_switches;
+    SDL_Texture* last_texture;
+};
+
+//Times one phase for the lifetime of the scope
+class ProfileScope {
+public:
+    ProfileScope(int phase) : phase(phase) {Profiler::instance().begin(phase);}
+    ~ProfileScope() {Profiler::instance().end(phase);}
+private:
+    int phase;
+};
+
+#endif // PROFILER_H
@@ -0,0 +1,95 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <functional>
+#include "threadpool.h"
+#include "taskgraph.h"
+
+TaskGraph::TaskGraph() {
+    unfinished=0;
+    lock=SDL_CreateMutex();
+    changed=SDL_CreateCond();
+}
+
+TaskGraph::~TaskGraph() {
+    SDL_DestroyCond(changed);
+    SDL_DestroyMutex(lock);
+}
+
+int TaskGraph::add(Task task, std::vector<int> dependencies, Affinity affinity) {
+    Node node;
+    node.task=task;
+    node.affinity=affinity;
+    node.waiting=dependencies.size();
+    node.result=false;
+    node.skip=false;
+    nodes.push_back(node);
+    int id=nodes.size()-1;
+    for(int i=0;i<(int)dependencies.size();i++) {
+        nodes[dependencies[i]].dependents.push_back(id);
+    }
+    return id;
+}
+
+bool TaskGraph::run(ThreadPool &pool) {
+    SDL_LockMutex(lock);
+    unfinished=nodes.size();
+    for(int i=0;i<(int)nodes.size();i++) {
+        if(nodes[i].waiting==0) {
+            start(i,pool);
+        }
+    }
+    while(unfinished>0) {
+        if(main_tasks.empty()) {
+            SDL_CondWait(changed,lock);
+            continue;
+        }
+        int task=main_tasks.front();
+        main_tasks.pop_front();
+        SDL_UnlockMutex(lock);
+        bool result=nodes[task].task();
+        SDL_LockMutex(lock);
+        finish(task,result,pool);
+    }
+    SDL_UnlockMutex(lock);
+    bool success=true;
+    for(int i=0;i<(int)nodes.size();i++) {
+        success=success && nodes[i].result;
+    }
+    return success;
+}
+
+void TaskGraph::start(int task, ThreadPool &pool) {
+    if(nodes[task].skip) {
+        finish(task,false,pool);
+    }
+    else if(nodes[task].affinity==MAIN) {
+        main_tasks.push_back(task);
+        SDL_CondSignal(changed);
+    }
+    else {
+        pool.push([this,task,&pool]() {
+            bool result=nodes[task].task();
+            SDL_LockMutex(lock);
+            finish(task,result,pool);
+            SDL_UnlockMutex(lock);
+        });
+    }
+}
+
+void TaskGraph::finish(int task, bool result, ThreadPool &pool) {
+    nodes[task].result=result;
+    unfinished--;
+    for(int i=0;i<(int)nodes[task].dependents.size();i++) {
+        Node &dependent=nodes[nodes[task].dependents[i]];
+        dependent.skip=dependent.skip || !result;
+        dependent.waiting--;
+        if(dependent.waiting==0) {
+            start(nodes[task].dependents[i],pool);
+        }
+    }
+    if(unfinished==0) {
+        SDL_CondSignal(changed);
+    }
+}
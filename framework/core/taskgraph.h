@@ -0,0 +1,44 @@
+#ifndef TASKGRAPH_H
+#define TASKGRAPH_H
+
+//A small dependency graph of startup work. A task starts once every task it depends on has succeeded; worker tasks
+//go to a ThreadPool and main tasks (anything touching the window or renderer) run on the thread that calls run().
+//If a task fails, everything that depends on it is skipped and counts as failed.
+
+class TaskGraph {
+public:
+    typedef std::function<bool()> Task;
+    enum Affinity {WORKER, MAIN};
+
+    //Constructors & Deconstructors
+    TaskGraph(); //Default Constructor
+    ~TaskGraph();
+
+    //Tasks
+    int add(Task task, std::vector<int> dependencies=std::vector<int>(), Affinity affinity=WORKER); //Returns the id of the task
+    bool run(ThreadPool &pool); //Runs every task and returns once all are finished, true if all of them succeeded
+
+    //Accessors
+    bool returnResult(int task) const {return nodes[task].result;} //True if the task ran and succeeded
+
+private:
+    struct Node {
+        Task task;
+        Affinity affinity;
+        std::vector<int> dependents;
+        int waiting; //unfinished dependencies
+        bool result;
+        bool skip; //a dependency failed
+    };
+
+    void start(int task, ThreadPool &pool); //Hands a ready task to its thread, called with lock held
+    void finish(int task, bool result, ThreadPool &pool); //Records a result and starts ready dependents, called with lock held
+
+    std::vector<Node> nodes;
+    std::deque<int> main_tasks; //ready tasks for the main thread
+    int unfinished;
+    SDL_mutex* lock;
+    SDL_cond* changed; //signalled when a main task is ready or the last task finishes
+};
+
+#endif // TASKGRAPH_H
@@ -0,0 +1,85 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <vector>
+#include <deque>
+#include <functional>
+#include "threadpool.h"
+
+ThreadPool::ThreadPool(int count) {
+    lock=SDL_CreateMutex();
+    wake=SDL_CreateCond();
+    idle=SDL_CreateCond();
+    running=0;
+    quit=false;
+    if(count<=0) {
+        count=SDL_GetCPUCount();
+    }
+    if(count<1) {
+        count=1;
+    }
+    for(int i=0;i<count;i++) {
+        SDL_Thread* thread=SDL_CreateThread(work,"worker",this);
+        if(thread==NULL) {
+            printf( "Unable to create worker thread! SDL Error: %s\n", SDL_GetError() );
+            break;
+        }
+        threads.push_back(thread);
+    }
+}
+
+ThreadPool::~ThreadPool() {
+    SDL_LockMutex(lock);
+    quit=true;
+    SDL_CondBroadcast(wake);
+    SDL_UnlockMutex(lock);
+    for(int i=0;i<(int)threads.size();i++) {
+        SDL_WaitThread(threads[i],NULL);
+    }
+    SDL_DestroyCond(idle);
+    SDL_DestroyCond(wake);
+    SDL_DestroyMutex(lock);
+}
+
+void ThreadPool::push(std::function<void()> job) {
+    if(threads.empty()) { //no workers could be started, run it here
+        job();
+        return;
+    }
+    SDL_LockMutex(lock);
+    jobs.push_back(job);
+    SDL_CondSignal(wake);
+    SDL_UnlockMutex(lock);
+}
+
+void ThreadPool::wait() {
+    SDL_LockMutex(lock);
+    while(!jobs.empty() || running>0) {
+        SDL_CondWait(idle,lock);
+    }
+    SDL_UnlockMutex(lock);
+}
+
+int ThreadPool::work(void* data) {
+    ThreadPool* pool=(ThreadPool*)data;
+    SDL_LockMutex(pool->lock);
+    while(true) {
+        while(pool->jobs.empty() && !pool->quit) {
+            SDL_CondWait(pool->wake,pool->lock);
+        }
+        if(pool->jobs.empty()) { //quit once the queue is drained
+            break;
+        }
+        std::function<void()> job=pool->jobs.front();
+        pool->jobs.pop_front();
+        pool->running++;
+        SDL_UnlockMutex(pool->lock);
+        job();
+        SDL_LockMutex(pool->lock);
+        pool->running--;
+        if(pool->running==0 && pool->jobs.empty()) {
+            SDL_CondBroadcast(pool->idle);
+        }
+    }
+    SDL_UnlockMutex(pool->lock);
+    return 0;
+}
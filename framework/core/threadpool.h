@@ -0,0 +1,31 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+//A fixed set of worker threads that run queued jobs in the order they were pushed.
+
+class ThreadPool {
+public:
+    //Constructors & Deconstructors
+    ThreadPool(int threads=0); //0 starts one worker per CPU core
+    ~ThreadPool(); //Finishes the queued jobs and stops the workers
+
+    //Jobs
+    void push(std::function<void()> job); //Queues a job for the next free worker
+    void wait(); //Blocks until the queue is empty and no job is running
+
+    //Accessors
+    int returnThreads() const {return threads.size();}
+
+private:
+    static int work(void* pool); //Worker thread loop
+
+    std::vector<SDL_Thread*> threads;
+    std::deque<std::function<void()> > jobs;
+    SDL_mutex* lock;
+    SDL_cond* wake; //signalled when a job is queued or the pool stops
+    SDL_cond* idle; //signalled when the last running job finishes
+    int running;
+    bool quit;
+};
+
+#endif // THREADPOOL_H
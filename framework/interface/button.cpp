@@ -5,29 +5,26 @@
 #include <fstream>
 #include <vector>
 #include <map>
-#include "texture.h"
+#include <memory>
+#include "../render/texturecache.h"
+#include "../render/atlas.h"
+#include "../render/spritebatch.h"
 #include "button.h"
 
-Button::Button(SDL_Renderer* Renderer, std::string path, int x_, int y_,int angle_=0) {
-    texture0.loadFromFile(Renderer,"../Settlements/assets/textures/ui/button/"+path+"/normal.png");
-    texture1.loadFromFile(Renderer,"../Settlements/assets/textures/ui/button/"+path+"/hover.png");
-    texture2.loadFromFile(Renderer,"../Settlements/assets/textures/ui/button/"+path+"/pressed.png");
+Button::Button(Atlas &atlas, std::string path, int x_, int y_,int angle_=0) {
+    sprite0=atlas.findSprite("ui/button/"+path,"normal");
+    sprite1=atlas.findSprite("ui/button/"+path,"hover");
+    sprite2=atlas.findSprite("ui/button/"+path,"pressed");
+    width=sprite0.rect.w;
+    height=sprite0.rect.h;
     x=x_;
     y=y_;
-    texture0.setAngle(angle_);
-    texture1.setAngle(angle_);
-    texture2.setAngle(angle_);
+    angle=angle_;
     state=0;
 }
 
-void Button::handleEvent(SDL_Event* e) {
+void Button::handleEvent(SDL_Event* e, bool inside) {
         activate=false;
-        int xm,ym;
-        bool inside=true;
-        SDL_GetMouseState(&xm,&ym);
-        if((renderrect.w!=0 && xm>renderrect.x+renderrect.w) || (renderrect.h!=0 && ym> renderrect.y+renderrect.h) || xm>renderrect.x+x+texture0.getWidth() || xm<x+renderrect.x || ym>renderrect.y+y+texture0.getHeight() || ym<y+renderrect.y) {
-            inside=false;
-        }
         if(!inside) {
             if(state==1 || 0) {
                 state=0;
@@ -64,15 +61,15 @@ void Button::handleEvent(SDL_Event* e) {
     }
 }
 
-void Button::render(SDL_Renderer* Renderer) {
+void Button::render(SpriteBatch &batch) {
     if(state==0) {
-        texture0.render(Renderer,x,y);
+        batch.add(sprite0,x,y,width,height,angle);
     }
     if(state==1) {
-        texture1.render(Renderer,x,y);
+        batch.add(sprite1,x,y,width,height,angle);
     }
     if(state==2) {
-        texture2.render(Renderer,x,y);
+        batch.add(sprite2,x,y,width,height,angle);
     }
 }
 
@@ -81,21 +78,17 @@ int Button::getState() {
 }
 
 int Button::getWidth() {
-    return texture0.getWidth();
+    return width;
 }
 
 int Button::getHeight() {
-    return texture0.getHeight();
+    return height;
 }
 
 void Button::setWidth(int w) {
-    texture0.setWidth(w);
-    texture1.setWidth(w);
-    texture2.setWidth(w);
+    width=w;
 }
 
 void Button::setHeight(int h) {
-    texture0.setHeight(h);
-    texture1.setHeight(h);
-    texture2.setHeight(h);
+    height=h;
 }
@@ -5,11 +5,11 @@ class Button {
 public:
     //Constructors & Deconstructors
     Button(){state=0;x=0;y=0;} //Default Constructor
-    Button(SDL_Renderer* Renderer, std::string path, int x_, int y_,int angle_); //Initializes All Variables
+    Button(Atlas &atlas, std::string path, int x_, int y_,int angle_); //Initializes All Variables
 
     //Rendering & Events
-    void handleEvent(SDL_Event* e);
-    void render(SDL_Renderer* Renderer);
+    void handleEvent(SDL_Event* e, bool inside); //inside is true if the mouse is over the button
+    void render(SpriteBatch &batch); //Queues the sprite for the current state
 
     //Accessors
     int getState();
@@ -25,14 +25,13 @@ public:
     void setHeight(int h);
     void setX(int x_);
     void setY(int y_);
-    void setRenderRect(SDL_Rect Rect_) {renderrect=Rect_;}
 
 private:
-    Texture texture0;
-    Texture texture1;
-    Texture texture2;
-    SDL_Rect renderrect={0,0,0,0};
+    Sprite sprite0;
+    Sprite sprite1;
+    Sprite sprite2;
     int state,x,y,angle;
+    int width=0,height=0;
     bool activate=false;
 };
 
@@ -5,24 +5,23 @@
 #include <fstream>
 #include <vector>
 #include <map>
-#include "texture.h"
+#include <memory>
+#include "../render/texturecache.h"
+#include "../render/atlas.h"
+#include "../render/spritebatch.h"
 #include "checkbox.h"
 
-Checkbox::Checkbox(SDL_Renderer* Renderer, std::string path, int x_, int y_) {
-    texture0.loadFromFile(Renderer,"../Settlements/assets/textures/ui/checkbox/"+path+"/normal.png");
-    texture1.loadFromFile(Renderer,"../Settlements/assets/textures/ui/checkbox/"+path+"/hover.png");
+Checkbox::Checkbox(Atlas &atlas, std::string path, int x_, int y_) {
+    sprite0=atlas.findSprite("ui/checkbox/"+path,"normal");
+    sprite1=atlas.findSprite("ui/checkbox/"+path,"hover");
+    width=sprite0.rect.w;
+    height=sprite0.rect.h;
     x=x_;
     y=y_;
     state=0;
 }
 
-void Checkbox::handleEvent(SDL_Event* e) {
-    int xm,ym;
-    bool inside=true;
-    SDL_GetMouseState(&xm,&ym);
-    if((renderrect.w!=0 && xm>renderrect.x+renderrect.w) || (renderrect.h!=0 && ym> renderrect.y+renderrect.h) || xm>renderrect.x+x+texture0.getWidth() || xm<x+renderrect.x || ym>renderrect.y+y+texture0.getHeight() || ym<y+renderrect.y) {
-        inside=false;
-    }
+void Checkbox::handleEvent(SDL_Event* e, bool inside) {
     if(!inside) {
         switch(e->type) {
             case SDL_MOUSEBUTTONDOWN:
@@ -52,12 +51,12 @@ void Checkbox::handleEvent(SDL_Event* e) {
         }
     }
 }
-void Checkbox::render(SDL_Renderer* Renderer) {
+void Checkbox::render(SpriteBatch &batch) {
     if(state==0) {
-        texture0.render(Renderer,x,y);
+        batch.add(sprite0,x,y,width,height);
     }
     if(state==1) {
-        texture1.render(Renderer,x,y);
+        batch.add(sprite1,x,y,width,height);
     }
 }
 
@@ -66,19 +65,17 @@ int Checkbox::getState() {
 }
 
 int Checkbox::getWidth() {
-    return texture0.getWidth();
+    return width;
 }
 
 int Checkbox::getHeight() {
-    return texture0.getHeight();
+    return height;
 }
 
 void Checkbox::setWidth(int w) {
-    texture0.setWidth(w);
-    texture1.setWidth(w);
+    width=w;
 }
 
 void Checkbox::setHeight(int h) {
-    texture0.setHeight(h);
-    texture1.setHeight(h);
+    height=h;
 }
@@ -6,11 +6,11 @@ class Checkbox {
 public:
     //Constructors & Deconstructors
     Checkbox(){state=0;x=0;y=0;} //Default Constructor
-    Checkbox(SDL_Renderer* Renderer, std::string path, int x_, int y_); //Initializes All Variables
+    Checkbox(Atlas &atlas, std::string path, int x_, int y_); //Initializes All Variables
 
     //Rendering & Events
-    void handleEvent(SDL_Event* e);
-    void render(SDL_Renderer* Renderer);
+    void handleEvent(SDL_Event* e, bool inside); //inside is true if the mouse is over the checkbox
+    void render(SpriteBatch &batch); //Queues the sprite for the current state
 
     //Accessors
     int getState();
@@ -26,13 +26,12 @@ public:
     void setHeight(int h);
     void setX(int x_);
     void setY(int y_);
-    void setRenderRect(SDL_Rect Rect_) {renderrect=Rect_;}
 
 private:
-    Texture texture0;
-    Texture texture1;
-    SDL_Rect renderrect={0,0,0,0};
+    Sprite sprite0;
+    Sprite sprite1;
     int state,x,y;
+    int width=0,height=0;
     int tmp=0;
 };
 
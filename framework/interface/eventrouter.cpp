@@ -0,0 +1,127 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include "eventrouter.h"
+
+EventRouter::EventRouter() {
+    columns=0;
+    rows=0;
+    captured=-1;
+    hovered=-1;
+}
+
+void EventRouter::init(int width_, int height_) {
+    columns=std::max((width_+CELL-1)/CELL,1);
+    rows=std::max((height_+CELL-1)/CELL,1);
+    grid.assign(columns*rows,std::vector<int>());
+    targets.clear();
+    captured=-1;
+    hovered=-1;
+}
+
+int EventRouter::add(SDL_Rect rect, Handler handler) {
+    Target target={rect,handler,true,true};
+    targets.push_back(target);
+    int id=targets.size()-1;
+    bucket(id,true);
+    return id;
+}
+
+void EventRouter::place(int id, SDL_Rect rect, bool enabled) {
+    Target &target=targets[id];
+    if(target.enabled) {
+        bucket(id,false);
+    }
+    target.rect=rect;
+    target.enabled=enabled && target.alive;
+    if(target.enabled) {
+        bucket(id,true);
+    }
+}
+
+void EventRouter::remove(int id) {
+    place(id,targets[id].rect,false);
+    targets[id].alive=false;
+    targets[id].handler=Handler();
+    if(captured==id) {
+        captured=-1;
+    }
+    if(hovered==id) {
+        hovered=-1;
+    }
+}
+
+bool EventRouter::cells(const SDL_Rect &rect, int &left, int &top, int &right, int &bottom) const {
+    if(rect.w<=0 || rect.h<=0) {
+        return false;
+    }
+    left=std::max(rect.x/CELL,0);
+    top=std::max(rect.y/CELL,0);
+    right=std::min((rect.x+rect.w-1)/CELL,columns-1);
+    bottom=std::min((rect.y+rect.h-1)/CELL,rows-1);
+    return rect.x+rect.w>0 && rect.y+rect.h>0 && left<=right && top<=bottom;
+}
+
+void EventRouter::bucket(int id, bool insert) {
+    int left, top, right, bottom;
+    if(!cells(targets[id].rect,left,top,right,bottom)) {
+        return;
+    }
+    for(int row=top;row<=bottom;row++) {
+        for(int column=left;column<=right;column++) {
+            std::vector<int> &cell=grid[row*columns+column];
+            if(insert) {
+                //Cells stay sorted by id, so the last match in a cell is the topmost
+                cell.insert(std::upper_bound(cell.begin(),cell.end(),id),id);
+            }
+            else {
+                cell.erase(std::remove(cell.begin(),cell.end(),id),cell.end());
+            }
+        }
+    }
+}
+
+int EventRouter::find(int x, int y) const {
+    if(x<0 || y<0 || x/CELL>=columns || y/CELL>=rows) {
+        return -1;
+    }
+    SDL_Point point={x,y};
+    const std::vector<int> &cell=grid[(y/CELL)*columns+x/CELL];
+    for(int i=cell.size()-1;i>=0;i--) {
+        if(SDL_PointInRect(&point,&targets[cell[i]].rect)) {
+            return cell[i];
+        }
+    }
+    return -1;
+}
+
+bool EventRouter::dispatch(SDL_Event* e) {
+    if(e->type!=SDL_MOUSEMOTION && e->type!=SDL_MOUSEBUTTONDOWN && e->type!=SDL_MOUSEBUTTONUP && e->type!=SDL_MOUSEWHEEL) {
+        return false;
+    }
+    int x, y;
+    SDL_GetMouseState(&x,&y);
+    SDL_Point point={x,y};
+    int target=captured!=-1 ? captured : find(x,y);
+
+    //The target the mouse left hears about it once
+    if(hovered!=-1 && hovered!=target && targets[hovered].alive) {
+        int left=hovered;
+        hovered=target;
+        targets[left].handler(e,x,y,false);
+    }
+    hovered=target;
+    if(target==-1) {
+        return false;
+    }
+    if(e->type==SDL_MOUSEBUTTONDOWN && captured==-1) {
+        captured=target;
+    }
+    targets[target].handler(e,x,y,SDL_PointInRect(&point,&targets[target].rect));
+    if(e->type==SDL_MOUSEBUTTONUP && captured==target) {
+        captured=-1;
+    }
+    return true;
+}
@@ -0,0 +1,53 @@
+#ifndef EVENTROUTER_H
+#define EVENTROUTER_H
+
+//Sends mouse events to the widget under the mouse. Every widget registers the rect it covers and a handler, and
+//the rects are kept in a grid of CELL sized cells, so finding the topmost widget at a point only looks at the few
+//widgets in one cell however many there are. Targets added later are on top.
+//
+//The mouse is read once per event. A target that gets a button press holds the capture until the button is
+//released, so drags keep going to it wherever the mouse goes. The target the mouse leaves gets the event too, told
+//the mouse isn't over it, so it can drop its hover state.
+
+class EventRouter {
+public:
+    typedef std::function<void(SDL_Event*, int, int, bool)> Handler; //event, mouse x and y, true if the mouse is over the target
+    enum {CELL=64};
+
+    //Constructors & Deconstructors
+    EventRouter(); //Default Constructor
+
+    //Targets
+    void init(int width_, int height_); //Size of the screen, drops every target
+    int add(SDL_Rect rect, Handler handler); //Registers a target on top of the others, returns its id, not from a handler
+    void place(int id, SDL_Rect rect, bool enabled=true); //Moves a target, a disabled one gets no events
+    void remove(int id);
+
+    //Events
+    bool dispatch(SDL_Event* e); //Sends a mouse event on, true if a target took it
+    void capture(int id) {captured=id;} //Sends every mouse event to id until release()
+    void release() {captured=-1;}
+    int find(int x, int y) const; //Topmost enabled target at x,y, -1 if none
+
+    //Accessors
+    int returnCaptured() const {return captured;}
+    int returnHovered() const {return hovered;}
+    int returnTargets() const {return targets.size();}
+
+private:
+    struct Target {
+        SDL_Rect rect;
+        Handler handler;
+        bool enabled, alive;
+    };
+
+    bool cells(const SDL_Rect &rect, int &left, int &top, int &right, int &bottom) const; //Cells a rect covers, false if none
+    void bucket(int id, bool insert); //Adds a target to, or takes it out of, the cells of its rect
+
+    std::vector<Target> targets; //by id
+    std::vector<std::vector<int> > grid; //ids of the targets in every cell, row by row
+    int columns, rows;
+    int captured, hovered; //-1 if none
+};
+
+#endif // EVENTROUTER_H
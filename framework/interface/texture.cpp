@@ -5,25 +5,26 @@
 #include <fstream>
 #include <vector>
 #include <map>
+#include <memory>
+#include "../core/profiler.h"
+#include "../render/texturecache.h"
 #include "texture.h"
 
 Texture::Texture() {
-    texture = NULL;
     width = 0;
     height = 0;
 }
 
 Texture::Texture(SDL_Renderer* Renderer, std::string path) {
+    width = 0;
+    height = 0;
     loadFromFile(Renderer, path);
 }
 
 Texture::Texture(SDL_Texture* t) {
-    free();
-    int w, h;
-    SDL_QueryTexture(t,NULL,NULL,&w,&h);
-    width=w;
-    height=h;
-    texture=t;
+    width = 0;
+    height = 0;
+    setTexture(t);
 }
 
 Texture::~Texture() {
@@ -32,67 +33,46 @@ Texture::~Texture() {
 }
 
 void Texture::setAsRenderTarget(SDL_Renderer* Renderer) {
-    SDL_SetRenderTarget(Renderer,texture );
+    SDL_SetRenderTarget(Renderer,texture.get() );
 }
 
-bool Texture::createBlank( SDL_Renderer* Renderer, int width, int height, SDL_TextureAccess access ) {
-    texture=NULL;
-    texture = SDL_CreateTexture(Renderer, SDL_PIXELFORMAT_RGBA8888, access, width, height );
-    if( texture == NULL ) {
-        printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
-    }
-    else {
-        width = width;
-        height = height;
+bool Texture::createBlank( SDL_Renderer* Renderer, int width_, int height_, SDL_TextureAccess access ) {
+    free();
+    texture = TextureCache::instance().create(Renderer, width_, height_, access);
+    if( texture ) {
+        width = width_;
+        height = height_;
     }
-    return texture != NULL;
+    return texture.get() != NULL;
 }
 
 bool Texture::loadFromFile(SDL_Renderer* Renderer, std::string path) {
     //Get rid of preexisting texture
     free();
-    //The final texture
-    SDL_Texture* newTexture = NULL;
-    //Load image at specified path
-    SDL_Surface* loadedSurface = IMG_Load(path.c_str());
-    if( loadedSurface == NULL ) {
-        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
-    }
-    else {
-        //Color key image
-        SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 255, 127, 127 ) );
-        //Create texture from surface pixels
-        newTexture = SDL_CreateTextureFromSurface(Renderer, loadedSurface);
-        if( newTexture == NULL ) {
-            printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
-        }
-        else {
-            //Get image dimensions
-            width = loadedSurface->w;
-            height = loadedSurface->h;
-        }
-
-        //Get rid of old loaded surface
-        SDL_FreeSurface(loadedSurface);
+    //Shared with every other Texture loaded from the same file
+    texture = TextureCache::instance().load(Renderer, path);
+    if( texture ) {
+        //Get image dimensions
+        SDL_QueryTexture(texture.get(),NULL,NULL,&width,&height);
     }
     //Return success
-    texture = newTexture;
-    return texture != NULL;
+    return texture.get() != NULL;
 }
 
 bool Texture::setTexture(SDL_Texture *t) {
     bool success=true;
-    int w, h;
+    free();
+    int w=0, h=0;
     SDL_QueryTexture(t,NULL,NULL,&w,&h);
     width=w;
     height=h;
-    texture=t;
+    texture=TextureCache::instance().adopt(t);
     return success;
 }
 
 void Texture::free() {
-    //Free texture if it exists
-    texture = NULL;
+    //Free texture if this was the last copy
+    texture.reset();
     width = 0;
     height = 0;
 }
@@ -105,9 +85,11 @@ void Texture::render(SDL_Renderer* Renderer, int x, int y, int w, int h) {
     else {
         renderQuad = {x,y,w,h};
     }
-    SDL_RenderCopyEx(Renderer,texture, NULL, &renderQuad,angle,NULL,SDL_FLIP_NONE);
+    Profiler::instance().countDraw(texture.get());
+    SDL_RenderCopyEx(Renderer,texture.get(), NULL, &renderQuad,angle,NULL,SDL_FLIP_NONE);
 }
 
 void Texture::renderRect(SDL_Renderer* Renderer, SDL_Rect* dstrect, SDL_Rect* srcrect) {
-    SDL_RenderCopy(Renderer,texture, srcrect, dstrect);
+    Profiler::instance().countDraw(texture.get());
+    SDL_RenderCopy(Renderer,texture.get(), srcrect, dstrect);
 }
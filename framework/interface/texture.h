@@ -6,8 +6,8 @@ class Texture {
         //Constructors & Deconstructors
         Texture(); //Default Constructor
         Texture(SDL_Renderer* Renderer, std::string path); //Create Texture from image
-        Texture(SDL_Texture* t);//Create texture from existing texture
-        ~Texture(); //Deallocates Memory
+        Texture(SDL_Texture* t);//Create texture from existing texture, the texture is freed with the last copy
+        ~Texture(); //Releases this copy, the texture is freed with the last copy
 
         //Rendering & Events
         bool createBlank( SDL_Renderer* Renderer, int width, int height, SDL_TextureAccess access);
@@ -17,7 +17,7 @@ class Texture {
         void renderRect(SDL_Renderer* Renderer, SDL_Rect* dstrect, SDL_Rect* srcrect); //Renders to rect
 
         //Accessors
-        SDL_Texture* getTexture() {return texture;} //return the texture
+        SDL_Texture* getTexture() {return texture.get();} //return the texture
         int getWidth() {return width;} //Get width of the texture
         int getHeight() {return height;} //Get height of the texture
 
@@ -25,14 +25,14 @@ class Texture {
         void setAngle(double angle_) {angle=angle_;}
         void setWidth(int width_) {width=width_;} //Set the width of the texture
         void setHeight(int height_) {height=height_;} //Set the height of the texture
-        bool setTexture(SDL_Texture* t); //Sets texture
+        bool setTexture(SDL_Texture* t); //Sets texture, taking ownership of it
 
         //Miscellaneous
-        void free();//Used by deconstructor to deallocate memory
+        void free();//Releases the texture, freeing it if this was the last copy
 
     private:
-        //The texture
-        SDL_Texture* texture;
+        //The texture, shared between copies and with the TextureCache
+        TextureHandle texture;
 
         //Parameters
         int width;
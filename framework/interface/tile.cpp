@@ -5,11 +5,23 @@
 #include <fstream>
 #include <vector>
 #include <map>
-#include "texture.h"
 #include "tile.h"
 
+//Values a tile's type doesn't set are 0, so a tile without >mobility can't be entered
+
+Tile::Tile() {
+    index=0; x=0; y=0; level=0;
+    frame_time=0;
+    mobility=0;
+    current_capacity=0; max_capacity=0;
+}
+
 Tile::Tile(std::string n) {
     name=n;
+    index=0; x=0; y=0; level=0;
+    frame_time=0;
+    mobility=0;
+    current_capacity=0; max_capacity=0;
 }
 
 Tile::Tile(Tile t, int i, int x_, int y_) {
@@ -17,8 +29,10 @@ Tile::Tile(Tile t, int i, int x_, int y_) {
     mobility=t.returnMobility();
     max_capacity=t.returnCapacity();
     level=t.returnLevel();
+    frame_time=t.returnFrameTime();
     edges=t.returnEdges();
     below=t.returnBelow();
+    current_capacity=0;
     index=i;
     x=x_;
     y=y_;
@@ -29,4 +43,8 @@ Tile::Tile(std::string n, int index_, int x_, int y_) {
     index=index_;
     x=x_;
     y=y_;
+    level=0;
+    frame_time=0;
+    mobility=0;
+    current_capacity=0; max_capacity=0;
 }
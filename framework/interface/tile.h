@@ -5,7 +5,7 @@
 class Tile {
 public:
     //Constructors & Deconstructors
-    Tile(){;} //Default Initializer
+    Tile(); //Default Initializer
     Tile(std::string n);
     Tile(Tile t, int i, int x_, int y_);
     Tile(std::string n, int index_, int x_, int y_); //Initialize All Variables
@@ -19,6 +19,7 @@ public:
     int returnCapacity() {return max_capacity;}
     int returnMobility() {return mobility;}
     int returnLevel() {return level;}
+    int returnFrameTime() {return frame_time;}
     std::string returnBelow() {return below;}
     std::string returnEdges() {return edges;}
 
@@ -27,6 +28,7 @@ public:
     void setCapacity(int c) {max_capacity=c;}
     void setMobility(int m) {mobility=m;}
     void setLevel(int l) {level=l;}
+    void setFrameTime(int f) {frame_time=f;}
     void setBelow(std::string b) {below=b;}
 
     std::vector<std::string> returnCommodities() {return commodities;}
@@ -34,6 +36,7 @@ public:
 private:
     std::string name,below;
     int index, x, y, level;
+    int frame_time; //Milliseconds each texture variant is shown for, 0 if the tile doesn't animate
 
     std::vector<std::pair<int,std::string> > resources;
     std::vector<std::string> commodities;
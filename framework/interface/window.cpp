@@ -6,7 +6,15 @@
 #include <fstream>
 #include <vector>
 #include <map>
+#include <memory>
+#include <functional>
+#include "../render/texturecache.h"
+#include "../render/atlas.h"
+#include "../render/spritebatch.h"
 #include "texture.h"
+#include "button.h"
+#include "checkbox.h"
+#include "eventrouter.h"
 #include "window.h"
 
 Window::Window() {
@@ -28,54 +36,94 @@ Window::~Window() {
     free();
 }
 
-void Window::render(SDL_Renderer *Renderer) {
-    if(!hide) {
-        SDL_Rect window_background;
-        window_background.x=x;window_background.y=y;window_background.w=width;window_background.h=height;
-
-        SDL_Rect window_heading;
-        window_heading.x=x; window_heading.y=y; window_heading.w=width; window_heading.h=6;
-
-        SDL_Rect window_heading2;
-        window_heading2.x=x+1; window_heading2.y=y+1; window_heading2.w=width-2; window_heading2.h=4;
+void Window::render(SDL_Renderer *Renderer, SpriteBatch &batch) {
+    if(hide || width<=0 || height<=0) {
+        return;
+    }
+    if(stale || cache.getWidth()!=width || cache.getHeight()!=height) {
+        redraw(Renderer);
+    }
+    SDL_Rect rect={x,y,width,height};
+    batch.addTexture(cache.getTexture(),rect);
+}
 
-        SDL_Rect window_border_bottom;
-        window_border_bottom.x=x; window_border_bottom.y=y+height-1; window_border_bottom.w=width; window_border_bottom.h=1;
+//Draws the frame, the content and the children into the window's texture at 0,0 with one flush of its own batch
 
-        SDL_Rect window_border_right;
-        window_border_right.x=x+width-1; window_border_right.y=y; window_border_right.w=1; window_border_right.h=height;
+void Window::redraw(SDL_Renderer *Renderer) {
+    if(cache.getWidth()!=width || cache.getHeight()!=height) {
+        if(!cache.createBlank(Renderer,width,height,SDL_TEXTUREACCESS_TARGET)) {
+            printf( "Unable to create window texture! SDL Error: %s\n", SDL_GetError() );
+            return;
+        }
+        //The background covers the whole window, so it is copied opaque like the window the renderer used to fill
+        SDL_SetTextureBlendMode(cache.getTexture(),SDL_BLENDMODE_NONE);
+    }
+    //Changing the render target resets the viewport and clip, so they are restored after drawing
+    SDL_Rect viewport, clipped;
+    SDL_RenderGetViewport(Renderer,&viewport);
+    bool clipping=SDL_RenderIsClipEnabled(Renderer);
+    SDL_RenderGetClipRect(Renderer,&clipped);
+    SDL_Texture* target=SDL_GetRenderTarget(Renderer);
+    cache.setAsRenderTarget(Renderer);
+    SDL_RenderSetViewport(Renderer,NULL);
+    SDL_RenderSetClipRect(Renderer,NULL);
+    SDL_SetRenderDrawColor(Renderer,0,0,0,0);
+    SDL_RenderClear(Renderer);
 
-        SDL_Rect window_border_left;
-        window_border_left.x=x; window_border_left.y=y; window_border_left.w=1; window_border_left.h=height;
+    //The frame's rects share one draw call, the icons go on top of them
+    SDL_Rect window_background={0,0,width,height};
+    SDL_Rect window_heading={0,0,width,6};
+    SDL_Rect window_heading2={1,1,width-2,4};
+    SDL_Rect window_border_bottom={0,height-1,width,1};
+    SDL_Rect window_border_right={width-1,0,1,height};
+    SDL_Rect window_border_left={0,0,1,height};
+    SDL_Color background={255,255,255,255}, black={0,0,0,255}, heading={70,70,70,255};
+    chrome.setViewport(NULL);
+    chrome.addRect(window_background,background);
+    chrome.addRect(window_heading,black);
+    chrome.addRect(window_border_right,black);
+    chrome.addRect(window_border_bottom,black);
+    chrome.addRect(window_border_left,black);
+    chrome.addRect(window_heading2,heading);
+    SDL_Rect resize_rect={width-20,height-20,tresize.getWidth(),tresize.getHeight()};
+    SDL_Rect close_rect={width-20,0,tclose.getWidth(),tclose.getHeight()};
+    SDL_Rect min_rect={width-40,0,tmin.getWidth(),tmin.getHeight()};
+    chrome.addTexture(tresize.getTexture(),resize_rect);
+    chrome.addTexture(tclose.getTexture(),close_rect);
+    chrome.addTexture(tmin.getTexture(),min_rect);
 
-        SDL_SetRenderDrawColor(Renderer,255,255,255,150);
-        SDL_RenderFillRect(Renderer,&window_background);
-        SDL_SetRenderDrawColor(Renderer, 0, 0, 0, 255);
-        SDL_RenderFillRect(Renderer,&window_heading);
-        SDL_RenderFillRect(Renderer,&window_border_right);
-        SDL_RenderFillRect(Renderer,&window_border_bottom);
-        SDL_RenderFillRect(Renderer,&window_border_left);
-        SDL_SetRenderDrawColor(Renderer,70,70,70,255);
-        SDL_RenderFillRect(Renderer,&window_heading2);
-        SDL_SetRenderDrawColor(Renderer, 255,255, 255, 255);
-        tresize.render(Renderer,x+width-20, y+height-20);
-        tclose.render(Renderer,x+width-20,y);
-        tmin.render(Renderer,x+width-40,y);
+    SDL_Rect usable={1,6,width-2,height-7};
+    SDL_Rect area={usable.x,usable.y,usable.w-strip,usable.h};
+    if(content && area.w>0 && area.h>0) {
+        SDL_Rect inside={0,0,area.w,area.h};
+        chrome.setViewport(&area);
+        content(chrome,inside);
     }
+    if(strip>0 && usable.h>0) {
+        SDL_Rect side={usable.x+usable.w-strip,usable.y,strip,usable.h};
+        SDL_Rect strip_rect={0,0,side.w,side.h};
+        chrome.setViewport(&side);
+        chrome.addRect(strip_rect,black);
+        for(int i=0;i<(int)checkboxes.size();i++) {
+            checkboxes[i].render(chrome);
+        }
+        for(int i=0;i<(int)buttons.size();i++) {
+            buttons[i].render(chrome);
+        }
+    }
+    chrome.flush(Renderer);
+
+    SDL_SetRenderTarget(Renderer,target);
+    SDL_RenderSetViewport(Renderer,&viewport);
+    SDL_RenderSetClipRect(Renderer,clipping ? &clipped : NULL);
+    stale=false;
 }
 
-void Window::handleEvent(SDL_Event *e) {
-    int xm,ym;
-    SDL_GetMouseState(&xm,&ym);
+void Window::handleEvent(SDL_Event *e, int xm, int ym, bool inside_) {
     if(hide) {
         return;
     }
-    if(xm<x+width && xm>x && ym<y+height && ym>y) {
-        inside=true;
-    }
-    else {
-        inside=false;
-    }
+    inside=inside_;
     if(move) {
         switch(e->type) {
             case SDL_MOUSEMOTION:
@@ -140,6 +188,70 @@ void Window::handleEvent(SDL_Event *e) {
                 break;
         }
     }
+    sync();
+}
+
+Button &Window::addButton(const Button &button) {
+    buttons.push_back(button);
+    stale=true;
+    return buttons.back();
+}
+
+Checkbox &Window::addCheckbox(const Checkbox &checkbox) {
+    checkboxes.push_back(checkbox);
+    stale=true;
+    return checkboxes.back();
+}
+
+void Window::attach(EventRouter &router_) {
+    router=&router_;
+    target=router->add(returnRect(),[this](SDL_Event* e, int xm, int ym, bool inside_) {
+        handleEvent(e,xm,ym,inside_);
+    });
+    for(int i=0;i<(int)checkboxes.size();i++) {
+        router->add(SDL_Rect(),[this,i](SDL_Event* e, int, int, bool inside_) {
+            int state=checkboxes[i].getState();
+            checkboxes[i].handleEvent(e,inside_);
+            stale=stale || checkboxes[i].getState()!=state;
+        });
+    }
+    for(int i=0;i<(int)buttons.size();i++) {
+        router->add(SDL_Rect(),[this,i](SDL_Event* e, int, int, bool inside_) {
+            int state=buttons[i].getState();
+            buttons[i].handleEvent(e,inside_);
+            stale=stale || buttons[i].getState()!=state;
+        });
+    }
+    synced_hide=!hide; //forces the first sync
+    sync();
+}
+
+void Window::sync() {
+    SDL_Rect rect=returnRect();
+    if(router==NULL || (SDL_RectEquals(&rect,&synced) && hide==synced_hide)) {
+        return;
+    }
+    synced=rect;
+    synced_hide=hide;
+    bool enabled=!hide && width>0 && height>0;
+    router->place(target,rect,enabled);
+    //Children only take the part of them inside the strip
+    SDL_Rect side=returnStrip(), child;
+    int id=target+1;
+    for(int i=0;i<(int)checkboxes.size();i++,id++) {
+        SDL_Rect area={side.x+checkboxes[i].getX(),side.y+checkboxes[i].getY(),checkboxes[i].getWidth(),checkboxes[i].getHeight()};
+        router->place(id,SDL_IntersectRect(&area,&side,&child) ? child : SDL_Rect(),enabled);
+    }
+    for(int i=0;i<(int)buttons.size();i++,id++) {
+        SDL_Rect area={side.x+buttons[i].getX(),side.y+buttons[i].getY(),buttons[i].getWidth(),buttons[i].getHeight()};
+        router->place(id,SDL_IntersectRect(&area,&side,&child) ? child : SDL_Rect(),enabled);
+    }
+}
+
+SDL_Rect Window::returnStrip() {
+    SDL_Rect tmp;
+    tmp.x=x+width-1-strip; tmp.y=y+6; tmp.w=strip; tmp.h=height-7;
+    return tmp;
 }
 
 SDL_Rect Window::returnUsuableViewport() {
@@ -153,7 +265,8 @@ void Window::free() {
     y=0;
     width=0;
     height=0;
-    tresize.~Texture();
-    tclose.~Texture();
-    tmin.~Texture();
+    tresize.free();
+    tclose.free();
+    tmin.free();
+    cache.free();
 }
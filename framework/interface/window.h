@@ -1,17 +1,36 @@
 #ifndef WINDOW_H
 #define WINDOW_H
 
+//A window keeps its frame, its buttons and checkboxes and whatever content it shows drawn in a texture of its own,
+//so the screen is composed with one copy per window. The texture is only drawn again when a child changes state,
+//the window changes size or the content is invalidated. Children sit in a strip down the right of the window, the
+//content fills the rest of the usable part.
+//
+//attach() registers the window and its children with an EventRouter, which then sends them their events. The
+//window moves their targets whenever it moves, resizes or hides.
 
 class Window {
 public:
+    typedef std::function<void(SpriteBatch&, SDL_Rect)> Content; //Queues the content into a rect at 0,0 of the batch's viewport
+
     //Constructors & Deconstructors
     Window(); //Default Initializer
     Window(SDL_Renderer* Renderer, int x, int y, int w, int h); //Initialize All Variables
     ~Window(); //Deallocate Memory
 
     //Rendering & Events
-    void render(SDL_Renderer* Renderer); //Renders the window
-    void handleEvent(SDL_Event* e); //Handles changes due to events
+    void render(SDL_Renderer* Renderer, SpriteBatch &batch); //Queues the copy of the window to the screen, drawing it again first if it changed
+    void handleEvent(SDL_Event* e, int xm, int ym, bool inside_); //Handles changes due to events, xm and ym is the mouse
+    void attach(EventRouter &router_); //Has router_ send events to the window and its children, after the children are added
+    void invalidate() {stale=true;} //What the content shows changed
+
+    //Children
+    Button &addButton(const Button &button); //x,y of children are within the strip
+    Checkbox &addCheckbox(const Checkbox &checkbox);
+    Button &returnButton(int i) {return buttons[i];}
+    Checkbox &returnCheckbox(int i) {return checkboxes[i];}
+    int returnButtons() {return buttons.size();}
+    int returnCheckboxes() {return checkboxes.size();}
 
     //Accessors
     bool returnInside() {return inside;} //Return true if mouse is within window
@@ -25,14 +44,22 @@ public:
     int returnUsuableX() {return x+1;} //Return the display part of the window
     int returnUsuableY() {return y+6;} //Return the display part of the window
     SDL_Rect returnUsuableViewport();//Return the display part of the window
+    SDL_Rect returnRect() {SDL_Rect rect={x,y,width,height}; return rect;} //Part of the screen the window covers
+    SDL_Rect returnStrip(); //Part of the screen the children sit in
+    bool returnStale() {return stale;} //True until the next render() after anything in the window changed
 
     //Modifiers
-    void setHide(bool hide_) {hide=hide_;} //Allows external sources to hide or unhide window
+    void setHide(bool hide_) {hide=hide_; sync();} //Allows external sources to hide or unhide window
+    void setContent(Content content_) {content=content_; stale=true;}
+    void setStrip(int strip_) {strip=strip_; stale=true; synced.w=-1; sync();} //Width of the children's strip
 
     //Miscellaneous
     void free(); //Used by deconstructor to deallocate memory
 
 private:
+    void redraw(SDL_Renderer* Renderer); //Draws the window into its texture
+    void sync(); //Moves the router's targets to where the window and its children are now
+
     //Window Parameters
     int x, y, width, height;
     int max_w, max_h;
@@ -48,6 +75,21 @@ private:
     Texture tresize;
     Texture tclose;
     Texture tmin;
+
+    //Retained Contents
+    std::vector<Button> buttons;
+    std::vector<Checkbox> checkboxes;
+    Content content;
+    int strip=0;
+    Texture cache; //the whole window as last drawn
+    SpriteBatch chrome; //what redraw() draws into cache, kept apart from the screen's batch that may be recording
+    bool stale=true;
+
+    //Event Routing
+    EventRouter* router=NULL;
+    int target=-1; //the window's own target, its children's follow in order, checkboxes first
+    SDL_Rect synced={0,0,0,0}; //window rect the targets were last placed for
+    bool synced_hide=false;
 };
 
 #endif // WINDOW_H
@@ -0,0 +1,227 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <memory>
+#include "texturecache.h"
+#include "atlas.h"
+
+//Images are sorted by height and packed left to right into shelves
+struct Placement {
+    int group, variant;
+    int page;
+    int x, y;
+};
+
+static bool taller(const std::pair<SDL_Surface*,Placement*> &a, const std::pair<SDL_Surface*,Placement*> &b) {
+    if(a.first->h!=b.first->h) {
+        return a.first->h>b.first->h;
+    }
+    return a.first->w>b.first->w;
+}
+
+Atlas::Atlas() {
+}
+
+Atlas::~Atlas() {
+    free();
+}
+
+int Atlas::add(std::string group, std::string name) {
+    std::map<std::string,int>::iterator it=group_ids.find(group);
+    if(it==group_ids.end()) {
+        Group g;
+        g.name=group;
+        g.colour=0xFF000000;
+        g.sum[0]=0; g.sum[1]=0; g.sum[2]=0; g.sum[3]=0;
+        groups.push_back(g);
+        it=group_ids.insert(std::pair<std::string,int>(group,groups.size()-1)).first;
+    }
+    Group &g=groups[it->second];
+    Sprite empty={NULL,{0,0,0,0},0,0,0,0};
+    g.names.push_back(name);
+    g.surfaces.push_back(NULL);
+    g.sprites.push_back(empty);
+    g.pages.push_back(-1);
+    return g.sprites.size()-1;
+}
+
+void Atlas::add(std::string group, std::string name, SDL_Surface* surface) {
+    int variant=add(group,name);
+    setSurface(findGroup(group),variant,surface);
+}
+
+void Atlas::setSurface(int group, int variant, SDL_Surface* surface) {
+    //Same colour key as Texture::loadFromFile
+    SDL_SetColorKey(surface, SDL_TRUE, SDL_MapRGB(surface->format, 255, 127, 127));
+    groups[group].surfaces[variant]=surface;
+    groups[group].sprites[variant].rect.w=surface->w;
+    groups[group].sprites[variant].rect.h=surface->h;
+}
+
+bool Atlas::build(SDL_Renderer* Renderer, int page_size) {
+    SDL_RendererInfo info;
+    if(SDL_GetRendererInfo(Renderer,&info)==0 && info.max_texture_width>0) {
+        page_size=std::min(page_size,std::min(info.max_texture_width,info.max_texture_height));
+    }
+    return pack(page_size) && upload(Renderer);
+}
+
+bool Atlas::pack(int page_size) {
+    std::vector<Placement> placements;
+    for(int i=0;i<(int)groups.size();i++) {
+        for(int j=0;j<(int)groups[i].surfaces.size();j++) {
+            if(groups[i].surfaces[j]!=NULL) {
+                Placement p={i,j,0,0,0};
+                placements.push_back(p);
+            }
+        }
+    }
+    std::vector<std::pair<SDL_Surface*,Placement*> > order;
+    for(int i=0;i<(int)placements.size();i++) {
+        order.push_back(std::pair<SDL_Surface*,Placement*>(groups[placements[i].group].surfaces[placements[i].variant],&placements[i]));
+    }
+    std::sort(order.begin(),order.end(),taller);
+
+    //Shelf packing with a pixel of padding so scaled sprites don't bleed into each other
+    int first_page=pages.size()+packed.size();
+    std::vector<SDL_Rect> page_sizes; //used width and height of every new page
+    int page=first_page-1, x=0, y=0, shelf=0;
+    for(int i=0;i<(int)order.size();i++) {
+        SDL_Surface* surface=order[i].first;
+        if(x+surface->w>page_size) {
+            x=0;
+            y+=shelf;
+            shelf=0;
+        }
+        if(i==0 || y+surface->h>page_size) {
+            page++;
+            SDL_Rect size={0,0,0,0};
+            page_sizes.push_back(size);
+            x=0; y=0; shelf=0;
+        }
+        order[i].second->page=page;
+        order[i].second->x=x;
+        order[i].second->y=y;
+        SDL_Rect &size=page_sizes[page-first_page];
+        size.w=std::max(size.w,x+surface->w);
+        size.h=std::max(size.h,y+surface->h);
+        x+=surface->w+1;
+        shelf=std::max(shelf,surface->h+1);
+    }
+
+    //Blit every image into its page
+    for(int p=0;p<(int)page_sizes.size();p++) {
+        SDL_Surface* surface=SDL_CreateRGBSurfaceWithFormat(0,page_sizes[p].w,page_sizes[p].h,32,SDL_PIXELFORMAT_ARGB8888);
+        if(surface==NULL) {
+            printf( "Unable to create atlas page! SDL Error: %s\n", SDL_GetError() );
+            return false;
+        }
+        SDL_FillRect(surface,NULL,SDL_MapRGBA(surface->format,0,0,0,0));
+        packed.push_back(surface);
+    }
+    for(int i=0;i<(int)placements.size();i++) {
+        Placement &p=placements[i];
+        Group &g=groups[p.group];
+        SDL_Surface* image=g.surfaces[p.variant];
+        SDL_Surface* surface=packed[p.page-pages.size()];
+        SDL_Rect destination={p.x,p.y,image->w,image->h};
+        SDL_SetSurfaceBlendMode(image,SDL_BLENDMODE_NONE);
+        SDL_BlitSurface(image,NULL,surface,&destination);
+        //Average the opaque pixels, the page is ARGB8888 so they can be read directly
+        for(int y=0;y<image->h;y++) {
+            const Uint32* pixels=(const Uint32*)((const Uint8*)surface->pixels+(p.y+y)*surface->pitch)+p.x;
+            for(int x=0;x<image->w;x++) {
+                if((pixels[x]>>24)>=128) {
+                    g.sum[0]+=(pixels[x]>>16)&255;
+                    g.sum[1]+=(pixels[x]>>8)&255;
+                    g.sum[2]+=pixels[x]&255;
+                    g.sum[3]++;
+                }
+            }
+        }
+        if(g.sum[3]>0) {
+            g.colour=0xFF000000|(Uint32)(g.sum[0]/g.sum[3])<<16|(Uint32)(g.sum[1]/g.sum[3])<<8|(Uint32)(g.sum[2]/g.sum[3]);
+        }
+        float w=surface->w;
+        float h=surface->h;
+        Sprite sprite={NULL,{p.x,p.y,image->w,image->h},p.x/w,p.y/h,(p.x+image->w)/w,(p.y+image->h)/h};
+        g.sprites[p.variant]=sprite;
+        g.pages[p.variant]=p.page;
+        SDL_FreeSurface(image);
+        g.surfaces[p.variant]=NULL;
+    }
+    return true;
+}
+
+bool Atlas::upload(SDL_Renderer* Renderer) {
+    int first_page=pages.size();
+    for(int p=0;p<(int)packed.size();p++) {
+        SDL_Texture* texture=SDL_CreateTextureFromSurface(Renderer,packed[p]);
+        SDL_FreeSurface(packed[p]);
+        packed[p]=NULL;
+        if(texture==NULL) {
+            printf( "Unable to create atlas page! SDL Error: %s\n", SDL_GetError() );
+        }
+        else {
+            SDL_SetTextureBlendMode(texture,SDL_BLENDMODE_BLEND);
+        }
+        pages.push_back(TextureCache::instance().adopt(texture));
+    }
+    packed.clear();
+    for(int i=0;i<(int)groups.size();i++) {
+        for(int j=0;j<(int)groups[i].pages.size();j++) {
+            if(groups[i].pages[j]>=first_page) {
+                groups[i].sprites[j].page=pages[groups[i].pages[j]].get();
+                groups[i].pages[j]=-1;
+            }
+        }
+    }
+    for(int p=first_page;p<(int)pages.size();p++) {
+        if(!pages[p]) {
+            return false;
+        }
+    }
+    return true;
+}
+
+int Atlas::findGroup(std::string group) const {
+    std::map<std::string,int>::const_iterator it=group_ids.find(group);
+    if(it==group_ids.end()) {
+        return -1;
+    }
+    return it->second;
+}
+
+Sprite Atlas::findSprite(std::string group, std::string name) const {
+    int id=findGroup(group);
+    if(id!=-1) {
+        for(int i=0;i<(int)groups[id].names.size();i++) {
+            if(groups[id].names[i]==name) {
+                return groups[id].sprites[i];
+            }
+        }
+    }
+    printf("No sprite %s/%s in the atlas.\n",group.c_str(),name.c_str());
+    Sprite empty={NULL,{0,0,0,0},0,0,0,0};
+    return empty;
+}
+
+void Atlas::free() {
+    for(int i=0;i<(int)packed.size();i++) {
+        SDL_FreeSurface(packed[i]);
+    }
+    for(int i=0;i<(int)groups.size();i++) {
+        for(int j=0;j<(int)groups[i].surfaces.size();j++) {
+            if(groups[i].surfaces[j]!=NULL) {
+                SDL_FreeSurface(groups[i].surfaces[j]);
+            }
+        }
+    }
+    pages.clear();
+    packed.clear();
+    groups.clear();
+    group_ids.clear();
+}
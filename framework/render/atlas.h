@@ -0,0 +1,62 @@
+#ifndef ATLAS_H
+#define ATLAS_H
+
+//A part of an atlas page, valid as long as the atlas is. u0,v0 and u1,v1 are the corners of rect in texture coordinates.
+struct Sprite {
+    SDL_Texture* page;
+    SDL_Rect rect;
+    float u0, v0, u1, v1;
+};
+
+//Packs many small images into a few large page textures. Images are added as variants of a named group (usually
+//the directory they were loaded from), and sprites are looked up by group id and variant, so drawing a tile is
+//an array index and every sprite on a page can be drawn by one SpriteBatch call.
+
+class Atlas {
+public:
+    //Constructors & Deconstructors
+    Atlas(); //Default Constructor
+    ~Atlas(); //Destroys the page textures
+
+    //Loading
+    void add(std::string group, std::string name, SDL_Surface* surface); //Queues an image as the next variant of group, the atlas frees the surface
+    bool build(SDL_Renderer* Renderer, int page_size=1024); //Packs every queued image into pages and uploads them
+
+    //Loading in stages, so images can be decoded on other threads. Register every image first, then set the
+    //surfaces (different slots may be set from different threads), pack on any thread and upload on the main thread.
+    int add(std::string group, std::string name); //Reserves the next variant of group and returns its index
+    void setSurface(int group, int variant, SDL_Surface* surface); //Fills a reserved variant, the atlas frees the surface
+    bool pack(int page_size=1024); //Packs every image into page surfaces
+    bool upload(SDL_Renderer* Renderer); //Creates the page textures from the packed page surfaces
+
+    //Accessors
+    int findGroup(std::string group) const; //Returns the id of a group, -1 if there is none
+    int returnGroups() const {return groups.size();}
+    int returnVariants(int group) const {return groups[group].sprites.size();}
+    const Sprite &returnSprite(int group, int variant) const {return groups[group].sprites[variant];}
+    Sprite findSprite(std::string group, std::string name) const; //Looks a sprite up by group and file name, empty if missing
+    int returnPages() const {return pages.size();}
+    SDL_Texture* returnPage(int i) const {return pages[i].get();}
+    Uint32 returnColour(int group) const {return groups[group].colour;} //Average ARGB colour of the visible pixels of every variant
+
+    //Miscellaneous
+    void free(); //Destroys every page and forgets every sprite
+
+private:
+    struct Group {
+        std::string name;
+        std::vector<std::string> names; //file name of every variant
+        std::vector<Sprite> sprites;
+        std::vector<SDL_Surface*> surfaces; //images waiting to be packed
+        std::vector<int> pages; //page of every packed variant, until it is uploaded
+        Uint32 colour; //average colour, found while packing
+        Uint64 sum[4]; //red, green and blue totals and the number of pixels averaged
+    };
+
+    std::vector<Group> groups;
+    std::map<std::string,int> group_ids;
+    std::vector<TextureHandle> pages;
+    std::vector<SDL_Surface*> packed; //page surfaces waiting to be uploaded
+};
+
+#endif // ATLAS_H
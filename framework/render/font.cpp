@@ -0,0 +1,167 @@
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_ttf.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include "texturecache.h"
+#include "atlas.h"
+#include "spritebatch.h"
+#include "font.h"
+
+Font::Font() {
+    font=NULL;
+    height=0;
+    Sprite empty={NULL,{0,0,0,0},0,0,0,0};
+    for(int i=0;i<=LAST_GLYPH-FIRST_GLYPH;i++) {
+        glyphs[i].sprite=empty;
+        glyphs[i].advance=0;
+    }
+}
+
+Font::~Font() {
+    free();
+}
+
+bool Font::load(SDL_Renderer* Renderer, std::string path, int size) {
+    free();
+    font=TTF_OpenFont(path.c_str(),size);
+    if(font==NULL) {
+        printf( "Unable to open font %s! SDL_ttf Error: %s\n", path.c_str(), TTF_GetError() );
+        return false;
+    }
+    height=TTF_FontHeight(font);
+
+    //Rasterise every glyph once and pack them left to right into rows of one texture
+    SDL_Color white={255,255,255,255};
+    SDL_Surface* rendered[LAST_GLYPH-FIRST_GLYPH+1];
+    int page_w=512, x=0, y=0, row=0;
+    for(int c=FIRST_GLYPH;c<=LAST_GLYPH;c++) {
+        Glyph &glyph=glyphs[c-FIRST_GLYPH];
+        int minx, maxx, miny, maxy;
+        glyph.advance=0;
+        TTF_GlyphMetrics(font,c,&minx,&maxx,&miny,&maxy,&glyph.advance);
+        rendered[c-FIRST_GLYPH]=c==' ' ? NULL : TTF_RenderGlyph_Blended(font,c,white);
+        SDL_Surface* surface=rendered[c-FIRST_GLYPH];
+        Sprite empty={NULL,{0,0,0,0},0,0,0,0};
+        glyph.sprite=empty;
+        if(surface==NULL) {
+            continue;
+        }
+        if(x+surface->w>page_w) {
+            x=0;
+            y+=row+1;
+            row=0;
+        }
+        glyph.sprite.rect.x=x; glyph.sprite.rect.y=y; glyph.sprite.rect.w=surface->w; glyph.sprite.rect.h=surface->h;
+        x+=surface->w+1;
+        row=std::max(row,surface->h);
+    }
+    int page_h=y+row;
+    SDL_Surface* page=SDL_CreateRGBSurfaceWithFormat(0,page_w,std::max(page_h,1),32,SDL_PIXELFORMAT_ARGB8888);
+    if(page==NULL) {
+        printf( "Unable to create glyph texture! SDL Error: %s\n", SDL_GetError() );
+        for(int i=0;i<=LAST_GLYPH-FIRST_GLYPH;i++) {
+            SDL_FreeSurface(rendered[i]);
+        }
+        return false;
+    }
+    SDL_FillRect(page,NULL,SDL_MapRGBA(page->format,0,0,0,0));
+    for(int i=0;i<=LAST_GLYPH-FIRST_GLYPH;i++) {
+        if(rendered[i]!=NULL) {
+            SDL_SetSurfaceBlendMode(rendered[i],SDL_BLENDMODE_NONE);
+            SDL_BlitSurface(rendered[i],NULL,page,&glyphs[i].sprite.rect);
+            SDL_FreeSurface(rendered[i]);
+        }
+    }
+    texture=TextureCache::instance().adopt(SDL_CreateTextureFromSurface(Renderer,page));
+    SDL_FreeSurface(page);
+    if(!texture) {
+        printf( "Unable to create glyph texture! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    SDL_SetTextureBlendMode(texture.get(),SDL_BLENDMODE_BLEND);
+    for(int i=0;i<=LAST_GLYPH-FIRST_GLYPH;i++) {
+        Sprite &sprite=glyphs[i].sprite;
+        if(sprite.rect.w==0) {
+            continue;
+        }
+        sprite.page=texture.get();
+        sprite.u0=sprite.rect.x/(float)page_w;
+        sprite.v0=sprite.rect.y/(float)page_h;
+        sprite.u1=(sprite.rect.x+sprite.rect.w)/(float)page_w;
+        sprite.v1=(sprite.rect.y+sprite.rect.h)/(float)page_h;
+    }
+    return true;
+}
+
+const Font::Run &Font::layout(const std::string &text, SDL_Color color) {
+    std::string key=std::string((const char*)&color,sizeof(color))+text;
+    std::map<std::string,Run>::iterator it=runs.find(key);
+    if(it!=runs.end()) {
+        return it->second;
+    }
+    //Strings that change every frame would grow the cache forever, so it starts over once it is full
+    if(runs.size()>=MAX_RUNS) {
+        runs.clear();
+    }
+    Run &run=runs[key];
+    int x=0;
+    for(int i=0;i<(int)text.size();i++) {
+        int c=(unsigned char)text[i];
+        if(c<FIRST_GLYPH || c>LAST_GLYPH) {
+            c='?';
+        }
+        Glyph &glyph=glyphs[c-FIRST_GLYPH];
+        if(glyph.sprite.page!=NULL) {
+            const Sprite &s=glyph.sprite;
+            float corners[4][4]={{0,0,s.u0,s.v0},{(float)s.rect.w,0,s.u1,s.v0},{(float)s.rect.w,(float)s.rect.h,s.u1,s.v1},{0,(float)s.rect.h,s.u0,s.v1}};
+            for(int j=0;j<4;j++) {
+                SDL_Vertex vertex;
+                vertex.position.x=x+corners[j][0];
+                vertex.position.y=corners[j][1];
+                vertex.color=color;
+                vertex.tex_coord.x=corners[j][2];
+                vertex.tex_coord.y=corners[j][3];
+                run.vertices.push_back(vertex);
+            }
+        }
+        x+=glyph.advance;
+    }
+    run.width=x;
+    return run;
+}
+
+void Font::draw(SpriteBatch &batch, const std::string &text, int x, int y, SDL_Color color) {
+    if(font==NULL) {
+        return;
+    }
+    const Run &run=layout(text,color);
+    if(!run.vertices.empty()) {
+        batch.add(texture.get(),&run.vertices[0],run.vertices.size()/4,x,y);
+    }
+}
+
+int Font::measure(const std::string &text) {
+    int width=0;
+    for(int i=0;i<(int)text.size();i++) {
+        int c=(unsigned char)text[i];
+        if(c<FIRST_GLYPH || c>LAST_GLYPH) {
+            c='?';
+        }
+        width+=glyphs[c-FIRST_GLYPH].advance;
+    }
+    return width;
+}
+
+void Font::free() {
+    if(font!=NULL) {
+        TTF_CloseFont(font);
+    }
+    font=NULL;
+    texture.reset();
+    runs.clear();
+    height=0;
+}
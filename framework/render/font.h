@@ -0,0 +1,48 @@
+#ifndef FONT_H
+#define FONT_H
+
+//A TTF font at one size with its printable ASCII glyphs rasterised once into a glyph texture. Strings are laid out
+//from the cached glyph metrics and queued on a SpriteBatch. The quads of every string are kept as a static run,
+//so a label that doesn't change is neither rasterised nor laid out again.
+
+class Font {
+public:
+    enum {FIRST_GLYPH=32, LAST_GLYPH=126, MAX_RUNS=256};
+
+    //Constructors & Deconstructors
+    Font(); //Default Constructor
+    ~Font(); //Frees the font and its glyphs
+
+    //Rendering & Events
+    bool load(SDL_Renderer* Renderer, std::string path, int size); //Opens a font and rasterises its glyphs
+    void draw(SpriteBatch &batch, const std::string &text, int x, int y, SDL_Color color); //Queues a string with its top left at x,y
+
+    //Accessors
+    int measure(const std::string &text); //Width of a string in pixels
+    int returnHeight() {return height;} //Height of a line
+    int returnRuns() {return runs.size();} //Number of cached strings
+
+    //Miscellaneous
+    void free(); //Frees the font, its glyphs and every cached run
+
+private:
+    struct Glyph {
+        Sprite sprite; //empty for glyphs without pixels, like space
+        int advance;
+    };
+
+    struct Run {
+        std::vector<SDL_Vertex> vertices; //four per glyph, relative to the top left of the string
+        int width;
+    };
+
+    const Run &layout(const std::string &text, SDL_Color color); //Returns the cached run of a string, laying it out if it is new
+
+    TTF_Font* font;
+    TextureHandle texture;
+    Glyph glyphs[LAST_GLYPH-FIRST_GLYPH+1];
+    int height;
+    std::map<std::string,Run> runs; //keyed by colour and text
+};
+
+#endif // FONT_H
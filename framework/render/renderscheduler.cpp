@@ -0,0 +1,127 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include <algorithm>
+#include "texturecache.h"
+#include "atlas.h"
+#include "spritebatch.h"
+#include "renderscheduler.h"
+
+RenderScheduler::RenderScheduler() {
+    width=0;
+    height=0;
+    damaged=false;
+    area={0,0,0,0};
+    waking=false;
+    wake=0;
+    frames=0;
+    waits=0;
+}
+
+bool RenderScheduler::init(SDL_Renderer* Renderer, int width_, int height_) {
+    width=width_;
+    height=height_;
+    frame=TextureCache::instance().create(Renderer,width,height,SDL_TEXTUREACCESS_TARGET);
+    if(!frame) {
+        printf( "Unable to create frame target! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    damageAll();
+    return true;
+}
+
+void RenderScheduler::free() {
+    frame.reset();
+}
+
+void RenderScheduler::damage(SDL_Rect rect) {
+    SDL_Rect screen={0,0,width,height};
+    if(!SDL_IntersectRect(&rect,&screen,&rect)) {
+        return;
+    }
+    if(damaged) {
+        SDL_UnionRect(&area,&rect,&area);
+    }
+    else {
+        area=rect;
+        damaged=true;
+    }
+}
+
+void RenderScheduler::damageAll() {
+    SDL_Rect screen={0,0,width,height};
+    damage(screen);
+}
+
+void RenderScheduler::wakeAt(Uint32 time) {
+    if(!waking || (Sint32)(time-wake)<0) {
+        wake=time;
+        waking=true;
+    }
+}
+
+bool RenderScheduler::wait() {
+    if(damaged || SDL_PollEvent(NULL)) {
+        waking=false;
+        return false;
+    }
+    //With a NULL event SDL_WaitEventTimeout leaves the event in the queue for the event loop to handle
+    int timeout=-1;
+    if(waking) {
+        timeout=std::max((Sint32)(wake-SDL_GetTicks()),0);
+        waking=false;
+        if(timeout==0) {
+            return false;
+        }
+    }
+    if(timeout<0) {
+        SDL_WaitEvent(NULL);
+    }
+    else {
+        SDL_WaitEventTimeout(NULL,timeout);
+    }
+    waits++;
+    return true;
+}
+
+bool RenderScheduler::begin(SDL_Renderer* Renderer, SpriteBatch &batch) {
+    if(!damaged || !frame) {
+        return false;
+    }
+    SDL_SetRenderTarget(Renderer,frame.get());
+    SDL_RenderSetViewport(Renderer,NULL);
+    SDL_RenderSetClipRect(Renderer,NULL);
+    SDL_Color black={0,0,0,255};
+    batch.setLayer(CLEAR_LAYER);
+    batch.setViewport(NULL);
+    batch.setClip(&area);
+    batch.addRect(area,black);
+    return true;
+}
+
+bool RenderScheduler::clip(SpriteBatch &batch, const SDL_Rect &viewport) {
+    SDL_Rect part;
+    if(!SDL_IntersectRect(&viewport,&area,&part)) {
+        return false;
+    }
+    //The clip rectangle is relative to the viewport
+    batch.setViewport(&viewport);
+    part.x-=viewport.x;
+    part.y-=viewport.y;
+    batch.setClip(&part);
+    return true;
+}
+
+void RenderScheduler::present(SDL_Renderer* Renderer, SpriteBatch &batch) {
+    batch.flush(Renderer);
+    SDL_RenderSetClipRect(Renderer,NULL);
+    SDL_SetRenderTarget(Renderer,NULL);
+    SDL_RenderSetViewport(Renderer,NULL);
+    SDL_RenderCopy(Renderer,frame.get(),NULL,NULL);
+    SDL_RenderPresent(Renderer);
+    damaged=false;
+    frames++;
+}
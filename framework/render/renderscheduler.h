@@ -0,0 +1,50 @@
+#ifndef RENDERSCHEDULER_H
+#define RENDERSCHEDULER_H
+
+//Decides when and where the screen is drawn. The frame is kept in a render target between frames, so only the
+//part of the screen that changed, the damage, is drawn again before the target is copied to the window. When
+//nothing is damaged no frame is drawn at all and wait() sleeps in SDL_WaitEventTimeout until input arrives or
+//something asked to be looked at again with wakeAt().
+//
+//Damage is kept as one rectangle around every damaged area. The whole frame is queued in one SpriteBatch and drawn
+//by a single flush in present(). Each part of the frame is queued after clip(), which points the batch's viewport at
+//the part and clips it to the damage, so parts drawn over a damaged one are drawn again where they overlap it and
+//nowhere else. The damage is cleared to black in CLEAR_LAYER, below everything else in the batch.
+
+class RenderScheduler {
+public:
+    enum {CLEAR_LAYER=-1}; //batch layer begin() clears the damage in, the frame's own layers start at 0
+
+    //Constructors & Deconstructors
+    RenderScheduler(); //Default Constructor
+
+    //Damage
+    void damage(SDL_Rect area); //Area of the screen to draw again
+    void damageAll(); //The whole screen
+    void wakeAt(Uint32 time); //Something may change by time (SDL_GetTicks()) without any input, wait() returns by then
+    bool wait(); //Sleeps until input, a wake time or damage, true if it slept
+
+    //Rendering
+    bool init(SDL_Renderer* Renderer, int width_, int height_); //Creates the frame target and damages all of it
+    bool begin(SDL_Renderer* Renderer, SpriteBatch &batch); //Draws into the frame target and queues clearing the damage, false if nothing is damaged
+    bool clip(SpriteBatch &batch, const SDL_Rect &viewport); //Points the batch at a viewport clipped to the damage, false if the damage misses it
+    void present(SDL_Renderer* Renderer, SpriteBatch &batch); //Flushes the batch into the frame target, copies that to the window and presents, the damage is then clear
+    void free(); //Lets go of the frame target
+
+    //Accessors
+    bool returnDamaged() const {return damaged;}
+    SDL_Rect returnDamage() const {return area;}
+    Uint32 returnFrames() const {return frames;} //Frames drawn
+    Uint32 returnWaits() const {return waits;} //Times wait() slept
+
+private:
+    TextureHandle frame;
+    int width, height;
+    bool damaged;
+    SDL_Rect area; //everything damaged since the last present, when damaged
+    bool waking;
+    Uint32 wake; //earliest wakeAt() since the last wait, when waking
+    Uint32 frames, waits;
+};
+
+#endif // RENDERSCHEDULER_H
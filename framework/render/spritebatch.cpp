@@ -0,0 +1,227 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <math.h>
+#include <memory>
+#include "../core/profiler.h"
+#include "texturecache.h"
+#include "atlas.h"
+#include "spritebatch.h"
+
+static const double PI=3.14159265358979323846;
+
+SpriteBatch::SpriteBatch() {
+    State state={false,false,false,{0,0,0,0},{0,0,0,0}};
+    states.push_back(state);
+    current=0;
+    layer=0;
+    ordered=true;
+    calls=0;
+}
+
+void SpriteBatch::quad(SDL_Texture* page, const SDL_Vertex* corners) {
+    Command command={layer,current,page,(int)vertices.size(),(int)commands.size(),ordered};
+    commands.push_back(command);
+    vertices.insert(vertices.end(),corners,corners+4);
+}
+
+void SpriteBatch::add(const Sprite &sprite, int x, int y, int w, int h, double angle) {
+    if(sprite.page==NULL) {
+        return;
+    }
+    if(w==0 || h==0) {
+        w=sprite.rect.w;
+        h=sprite.rect.h;
+    }
+    //Corners clockwise from the top left, rotated around the centre like SDL_RenderCopyEx
+    float corners[4][2]={{0,0},{(float)w,0},{(float)w,(float)h},{0,(float)h}};
+    float uv[4][2]={{sprite.u0,sprite.v0},{sprite.u1,sprite.v0},{sprite.u1,sprite.v1},{sprite.u0,sprite.v1}};
+    float c=1, s=0;
+    if(angle!=0.0) {
+        c=cos(angle*PI/180.0);
+        s=sin(angle*PI/180.0);
+    }
+    SDL_Vertex quad_[4];
+    for(int i=0;i<4;i++) {
+        float dx=corners[i][0]-w*0.5f;
+        float dy=corners[i][1]-h*0.5f;
+        quad_[i].position.x=x+w*0.5f+dx*c-dy*s;
+        quad_[i].position.y=y+h*0.5f+dx*s+dy*c;
+        quad_[i].color.r=255; quad_[i].color.g=255; quad_[i].color.b=255; quad_[i].color.a=255;
+        quad_[i].tex_coord.x=uv[i][0];
+        quad_[i].tex_coord.y=uv[i][1];
+    }
+    quad(sprite.page,quad_);
+}
+
+void SpriteBatch::add(SDL_Texture* page, const SDL_Vertex* quads, int count, float x, float y) {
+    if(page==NULL) {
+        return;
+    }
+    for(int i=0;i<count;i++) {
+        SDL_Vertex quad_[4];
+        for(int j=0;j<4;j++) {
+            quad_[j]=quads[i*4+j];
+            quad_[j].position.x+=x;
+            quad_[j].position.y+=y;
+        }
+        quad(page,quad_);
+    }
+}
+
+void SpriteBatch::addTexture(SDL_Texture* texture, const SDL_Rect &dest) {
+    if(texture==NULL) {
+        return;
+    }
+    Sprite sprite={texture,dest,0,0,1,1};
+    add(sprite,dest.x,dest.y,dest.w,dest.h);
+}
+
+void SpriteBatch::addTexture(SDL_Texture* texture, int texture_w, int texture_h, const SDL_Rect &src, const SDL_Rect &dest) {
+    if(texture==NULL || texture_w<=0 || texture_h<=0) {
+        return;
+    }
+    Sprite sprite={texture,dest,(float)src.x/texture_w,(float)src.y/texture_h,(float)(src.x+src.w)/texture_w,(float)(src.y+src.h)/texture_h};
+    add(sprite,dest.x,dest.y,dest.w,dest.h);
+}
+
+void SpriteBatch::addRect(const SDL_Rect &rect, SDL_Color color) {
+    float corners[4][2]={{0,0},{(float)rect.w,0},{(float)rect.w,(float)rect.h},{0,(float)rect.h}};
+    SDL_Vertex quad_[4];
+    for(int i=0;i<4;i++) {
+        quad_[i].position.x=rect.x+corners[i][0];
+        quad_[i].position.y=rect.y+corners[i][1];
+        quad_[i].color=color;
+        quad_[i].tex_coord.x=0;
+        quad_[i].tex_coord.y=0;
+    }
+    quad(NULL,quad_);
+}
+
+void SpriteBatch::setLayer(int layer_, bool ordered_) {
+    layer=layer_;
+    ordered=ordered_;
+}
+
+void SpriteBatch::pushState() {
+    //A state nothing was recorded with yet is changed in place
+    if(current==(int)states.size()-1 && current!=0 && (commands.empty() || commands.back().state!=current)) {
+        return;
+    }
+    states.push_back(states[current]);
+    current=states.size()-1;
+}
+
+void SpriteBatch::setViewport(const SDL_Rect* rect) {
+    pushState();
+    states[current].viewport=true;
+    states[current].whole=rect==NULL;
+    if(rect!=NULL) {
+        states[current].viewport_rect=*rect;
+    }
+}
+
+void SpriteBatch::setClip(const SDL_Rect* rect) {
+    pushState();
+    states[current].clip=rect!=NULL;
+    if(rect!=NULL) {
+        states[current].clip_rect=*rect;
+    }
+}
+
+void SpriteBatch::append(SpriteBatch &other) {
+    int vertex_offset=vertices.size(), state_offset=states.size()-1, sequence_offset=commands.size();
+    vertices.insert(vertices.end(),other.vertices.begin(),other.vertices.end());
+    states.insert(states.end(),other.states.begin()+1,other.states.end());
+    for(int i=0;i<(int)other.commands.size();i++) {
+        Command command=other.commands[i];
+        command.first+=vertex_offset;
+        command.state=command.state==0 ? 0 : command.state+state_offset;
+        command.sequence+=sequence_offset;
+        commands.push_back(command);
+    }
+    other.vertices.clear();
+    other.commands.clear();
+    other.states.resize(1);
+    other.current=0;
+}
+
+bool SpriteBatch::Sooner::operator()(const Command &a, const Command &b) const {
+    if(a.layer!=b.layer) {
+        return a.layer<b.layer;
+    }
+    if(a.ordered!=b.ordered) {
+        return a.ordered;
+    }
+    if(!a.ordered) {
+        if(a.state!=b.state) {
+            return a.state<b.state;
+        }
+        if(a.page!=b.page) {
+            return std::less<SDL_Texture*>()(a.page,b.page);
+        }
+    }
+    return a.sequence<b.sequence;
+}
+
+void SpriteBatch::flush(SDL_Renderer* Renderer) {
+    calls=0;
+    if(!commands.empty()) {
+        std::sort(commands.begin(),commands.end(),Sooner());
+
+        //Indices in drawing order, so every run is one stretch of them
+        indices.resize(commands.size()*6);
+        const int corners[6]={0,1,2,0,2,3};
+        for(int i=0;i<(int)commands.size();i++) {
+            for(int j=0;j<6;j++) {
+                indices[i*6+j]=commands[i].first+corners[j];
+            }
+        }
+
+        //The renderer's own viewport and clip, for state 0 and to put back afterwards
+        bool touched=states.size()>1;
+        SDL_Rect viewport, clip;
+        bool clipping=false;
+        if(touched) {
+            SDL_RenderGetViewport(Renderer,&viewport);
+            clipping=SDL_RenderIsClipEnabled(Renderer);
+            SDL_RenderGetClipRect(Renderer,&clip);
+        }
+        int applied=0;
+        for(int first=0;first<(int)commands.size();) {
+            int last=first+1;
+            while(last<(int)commands.size() && commands[last].page==commands[first].page && commands[last].state==commands[first].state) {
+                last++;
+            }
+            int state=commands[first].state;
+            if(state!=applied) {
+                const State &s=states[state];
+                SDL_RenderSetViewport(Renderer,!s.viewport ? &viewport : s.whole ? NULL : &s.viewport_rect);
+                if(state==0) {
+                    SDL_RenderSetClipRect(Renderer,clipping ? &clip : NULL);
+                }
+                else {
+                    SDL_RenderSetClipRect(Renderer,s.clip ? &s.clip_rect : NULL);
+                }
+                applied=state;
+            }
+            Profiler::instance().countDraw(commands[first].page);
+            SDL_RenderGeometry(Renderer,commands[first].page,&vertices[0],vertices.size(),&indices[first*6],(last-first)*6);
+            calls++;
+            first=last;
+        }
+        if(touched && applied!=0) {
+            SDL_RenderSetViewport(Renderer,&viewport);
+            SDL_RenderSetClipRect(Renderer,clipping ? &clip : NULL);
+        }
+    }
+    vertices.clear();
+    commands.clear();
+    states.resize(1);
+    current=0;
+    layer=0;
+    ordered=true;
+}
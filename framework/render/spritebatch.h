@@ -0,0 +1,65 @@
+#ifndef SPRITEBATCH_H
+#define SPRITEBATCH_H
+
+//A buffer of draw commands: sprites, prepared quads, whole textures and filled rects, each recorded as a textured
+//quad (rects have no texture) under a layer and a viewport and clip state. Recording makes no SDL calls, so a batch
+//can be filled on any thread and appended to the one the main thread flushes.
+//
+//flush() sorts the commands by layer, lowest first. An ordered layer keeps the order its commands were recorded in,
+//so overlapping sprites still draw back to front. An unordered layer is for commands that don't overlap, and is
+//grouped by viewport and clip and then by texture. Runs of commands that end up next to each other with the same
+//texture and state are drawn with one SDL_RenderGeometry call, and the viewport and clip are only set when they
+//change. A batch that never sets them draws into whatever viewport the renderer has.
+
+class SpriteBatch {
+public:
+    //Constructors & Deconstructors
+    SpriteBatch(); //Default Constructor
+
+    //Recording
+    void add(const Sprite &sprite, int x, int y, int w=0, int h=0, double angle=0.0); //Queues a sprite, w or h of 0 uses the sprite size
+    void add(SDL_Texture* page, const SDL_Vertex* quads, int count, float x, float y); //Queues count prepared quads (4 vertices each) moved by x,y
+    void addTexture(SDL_Texture* texture, const SDL_Rect &dest); //Queues a whole texture stretched over dest
+    void addTexture(SDL_Texture* texture, int texture_w, int texture_h, const SDL_Rect &src, const SDL_Rect &dest); //Queues the src part of a texture_w by texture_h texture
+    void addRect(const SDL_Rect &rect, SDL_Color color); //Queues a filled rect, rects of any colour share a draw call
+    void setLayer(int layer_, bool ordered_=true); //Commands after this go in layer_
+    void setViewport(const SDL_Rect* rect); //Viewport of the commands after this, NULL for the whole target
+    void setClip(const SDL_Rect* rect); //Clip of the commands after this, relative to the viewport, NULL for none
+    void append(SpriteBatch &other); //Moves the commands of other, recorded on any thread, to the end of this batch
+
+    //Rendering
+    void flush(SDL_Renderer* Renderer); //Sorts, draws and clears everything queued
+
+    //Accessors
+    int returnQueued() const {return commands.size();} //Number of quads waiting to be drawn
+    int returnCalls() const {return calls;} //Draw calls the last flush made
+
+private:
+    struct State {
+        bool viewport, whole, clip; //viewport false keeps the renderer's, whole is the whole target, clip false clips nothing
+        SDL_Rect viewport_rect, clip_rect;
+    };
+    struct Command {
+        int layer;
+        int state; //index into states
+        SDL_Texture* page; //NULL for a filled rect
+        int first; //first of its 4 vertices
+        int sequence; //when it was recorded
+        bool ordered;
+    };
+    struct Sooner {bool operator()(const Command &a, const Command &b) const;}; //flush order
+
+    void quad(SDL_Texture* page, const SDL_Vertex* corners); //Records 4 vertices as a command
+    void pushState(); //Starts a state after a viewport or clip change
+
+    std::vector<SDL_Vertex> vertices;
+    std::vector<Command> commands;
+    std::vector<State> states; //0 leaves the renderer's viewport and clip alone
+    int current; //state of the commands being recorded
+    std::vector<int> indices; //scratch for flush
+    int layer;
+    bool ordered;
+    int calls;
+};
+
+#endif // SPRITEBATCH_H
@@ -0,0 +1,96 @@
+#include <SDL2/SDL_image.h>
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <memory>
+#include "texturecache.h"
+
+//The same file can be written "..//a//b.png" or "../a/b.png"
+static std::string normalize(std::string path) {
+    std::string key;
+    for(int i=0;i<(int)path.size();i++) {
+        char c=path[i]=='\\' ? '/' : path[i];
+        if(c=='/' && !key.empty() && key[key.size()-1]=='/') {
+            continue;
+        }
+        key+=c;
+    }
+    return key;
+}
+
+TextureCache &TextureCache::instance() {
+    static TextureCache cache;
+    return cache;
+}
+
+TextureHandle TextureCache::load(SDL_Renderer* Renderer, std::string path) {
+    std::string key=normalize(path);
+    std::map<std::string,std::weak_ptr<SDL_Texture> >::iterator it=keys.find(key);
+    if(it!=keys.end()) {
+        TextureHandle texture=it->second.lock();
+        if(texture) {
+            hits++;
+            return texture;
+        }
+    }
+    //Load image at specified path
+    SDL_Surface* loadedSurface = IMG_Load(path.c_str());
+    if( loadedSurface == NULL ) {
+        printf( "Unable to load image %s! SDL_image Error: %s\n", path.c_str(), IMG_GetError() );
+        return TextureHandle();
+    }
+    loads++;
+    //Color key image
+    SDL_SetColorKey(loadedSurface, SDL_TRUE, SDL_MapRGB( loadedSurface->format, 255, 127, 127 ) );
+    //Create texture from surface pixels
+    SDL_Texture* newTexture = SDL_CreateTextureFromSurface(Renderer, loadedSurface);
+    SDL_FreeSurface(loadedSurface);
+    if( newTexture == NULL ) {
+        printf( "Unable to create texture from %s! SDL Error: %s\n", path.c_str(), SDL_GetError() );
+        return TextureHandle();
+    }
+    TextureHandle texture=track(newTexture,key);
+    keys[key]=texture;
+    return texture;
+}
+
+TextureHandle TextureCache::create(SDL_Renderer* Renderer, int w, int h, SDL_TextureAccess access) {
+    SDL_Texture* texture = SDL_CreateTexture(Renderer, SDL_PIXELFORMAT_RGBA8888, access, w, h );
+    if( texture == NULL ) {
+        printf( "Unable to create blank texture! SDL Error: %s\n", SDL_GetError() );
+        return TextureHandle();
+    }
+    return track(texture,"");
+}
+
+TextureHandle TextureCache::adopt(SDL_Texture* texture) {
+    if(texture==NULL) {
+        return TextureHandle();
+    }
+    return track(texture,"");
+}
+
+TextureHandle TextureCache::track(SDL_Texture* texture, std::string key) {
+    int w=0, h=0;
+    SDL_QueryTexture(texture,NULL,NULL,&w,&h);
+    Entry entry;
+    entry.key=key;
+    entry.bytes=(long long)w*h*4; //every texture is treated as 32 bits per pixel
+    resident[texture]=entry;
+    bytes+=entry.bytes;
+    return TextureHandle(texture,[](SDL_Texture* t) {TextureCache::instance().release(t);});
+}
+
+void TextureCache::release(SDL_Texture* texture) {
+    std::map<SDL_Texture*,Entry>::iterator it=resident.find(texture);
+    if(it!=resident.end()) {
+        bytes-=it->second.bytes;
+        if(!it->second.key.empty()) {
+            keys.erase(it->second.key);
+        }
+        resident.erase(it);
+    }
+    SDL_DestroyTexture(texture);
+}
@@ -0,0 +1,41 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+//A texture shared between everything holding a handle to it. The GPU memory is freed when the last handle goes away.
+typedef std::shared_ptr<SDL_Texture> TextureHandle;
+
+//Every texture in the game is created through this cache. Images are keyed by their path so each file is loaded
+//once no matter how many Textures use it, and the cache keeps count of every resident texture and its memory.
+
+class TextureCache {
+public:
+    static TextureCache &instance(); //The cache shared by the whole game
+
+    //Loading
+    TextureHandle load(SDL_Renderer* Renderer, std::string path); //Shared texture of an image, loaded on first use
+    TextureHandle create(SDL_Renderer* Renderer, int w, int h, SDL_TextureAccess access); //New blank texture
+    TextureHandle adopt(SDL_Texture* texture); //Takes ownership of a texture created elsewhere
+
+    //Accessors
+    int returnResident() const {return resident.size();} //Number of textures in memory
+    long long returnBytes() const {return bytes;} //Estimated video memory of every resident texture
+    int returnLoads() const {return loads;} //Images read from disk
+    int returnHits() const {return hits;} //Loads answered by a texture already in memory
+
+private:
+    TextureCache() {bytes=0;loads=0;hits=0;}
+    TextureHandle track(SDL_Texture* texture, std::string key); //Wraps a texture in a handle that releases it
+    void release(SDL_Texture* texture); //Destroys a texture once its last handle is gone
+
+    struct Entry {
+        std::string key; //empty for textures that weren't loaded from a file
+        long long bytes;
+    };
+
+    std::map<SDL_Texture*,Entry> resident;
+    std::map<std::string,std::weak_ptr<SDL_Texture> > keys;
+    long long bytes;
+    int loads, hits;
+};
+
+#endif // TEXTURECACHE_H
@@ -0,0 +1,143 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include "../core/threadpool.h"
+#include "../interface/tile.h"
+#include "../terrain/terraingrid.h"
+#include "../terrain/tiledatabase.h"
+#include "simulation.h"
+#include "simthread.h"
+
+SimThread::SimThread(int threads) : pool(threads) {
+    sim=NULL;
+    thread=NULL;
+    lock=SDL_CreateMutex();
+    wake=SDL_CreateCond();
+    quit=false;
+    interval=100;
+    tick_time=0;
+    dropped=0;
+}
+
+SimThread::~SimThread() {
+    stop();
+    SDL_DestroyCond(wake);
+    SDL_DestroyMutex(lock);
+}
+
+bool SimThread::start(Simulation &sim_, Uint32 interval_) {
+    stop();
+    sim=&sim_;
+    interval=std::max(interval_,(Uint32)1);
+    quit=false;
+    edits.clear();
+    latest=std::make_shared<Simulation::Snapshot>();
+    sim->snapshot(*latest);
+    previous=latest;
+    thread=SDL_CreateThread(run,"simulation",this);
+    if(thread==NULL) {
+        printf( "Unable to create simulation thread! SDL Error: %s\n", SDL_GetError() );
+        return false;
+    }
+    return true;
+}
+
+void SimThread::stop() {
+    if(thread==NULL) {
+        return;
+    }
+    SDL_LockMutex(lock);
+    quit=true;
+    SDL_CondSignal(wake);
+    SDL_UnlockMutex(lock);
+    SDL_WaitThread(thread,NULL);
+    thread=NULL;
+}
+
+void SimThread::edit(int tile, int type) {
+    SDL_LockMutex(lock);
+    edits.push_back(std::make_pair(tile,type));
+    SDL_UnlockMutex(lock);
+}
+
+void SimThread::view(std::shared_ptr<const Simulation::Snapshot> &previous_, std::shared_ptr<const Simulation::Snapshot> &latest_) const {
+    SDL_LockMutex(lock);
+    previous_=previous;
+    latest_=latest;
+    SDL_UnlockMutex(lock);
+}
+
+float SimThread::blend(const Simulation::Snapshot &latest_, Uint32 now) const {
+    float t=(float)(Sint32)(now-latest_.time)/interval;
+    return std::min(std::max(t,0.0f),1.0f);
+}
+
+float SimThread::population(const Simulation::Snapshot &previous_, const Simulation::Snapshot &latest_, int settlement, float blend) {
+    if(previous_.layout!=latest_.layout) { //settlements were sorted in between, there is nothing to blend with
+        return latest_.population[settlement];
+    }
+    return previous_.population[settlement]+(latest_.population[settlement]-previous_.population[settlement])*blend;
+}
+
+float SimThread::returnTickTime() const {
+    SDL_LockMutex(lock);
+    float time=tick_time;
+    SDL_UnlockMutex(lock);
+    return time;
+}
+
+Uint32 SimThread::returnDropped() const {
+    SDL_LockMutex(lock);
+    Uint32 count=dropped;
+    SDL_UnlockMutex(lock);
+    return count;
+}
+
+int SimThread::run(void* data) {
+    ((SimThread*)data)->loop();
+    return 0;
+}
+
+void SimThread::loop() {
+    std::vector<std::pair<int,int> > pending;
+    Uint32 next=SDL_GetTicks()+interval;
+    SDL_LockMutex(lock);
+    while(!quit) {
+        Sint32 wait=(Sint32)(next-SDL_GetTicks());
+        if(wait>0) {
+            SDL_CondWaitTimeout(wake,lock,wait);
+            continue;
+        }
+        pending.swap(edits);
+        SDL_UnlockMutex(lock);
+
+        Uint64 started=SDL_GetPerformanceCounter();
+        for(int i=0;i<(int)pending.size();i++) {
+            sim->update(pending[i].first,pending[i].second);
+        }
+        pending.clear();
+        sim->tick(pool);
+        std::shared_ptr<Simulation::Snapshot> snapshot=std::make_shared<Simulation::Snapshot>(); //the render loop may still hold the old ones
+        sim->snapshot(*snapshot);
+        float took=(SDL_GetPerformanceCounter()-started)*1000.0f/SDL_GetPerformanceFrequency();
+
+        SDL_LockMutex(lock);
+        previous=latest;
+        latest=snapshot;
+        tick_time=took;
+        next+=interval;
+        Sint32 behind=(Sint32)(SDL_GetTicks()-next);
+        if(behind>(Sint32)(CATCH_UP*interval)) { //too far behind to catch up, the game slows down instead
+            dropped+=behind/interval;
+            next=SDL_GetTicks();
+        }
+    }
+    SDL_UnlockMutex(lock);
+}
@@ -0,0 +1,54 @@
+#ifndef SIMTHREAD_H
+#define SIMTHREAD_H
+
+//Runs a Simulation on its own thread at a fixed rate, apart from the render loop. Every tick stands for interval
+//milliseconds of game time however long it takes, so a slow tick never holds up a frame and a fast display never
+//speeds up the game. A thread that falls behind runs ticks back to back to catch up, at most CATCH_UP of them,
+//and drops the rest of the time.
+//
+//After each tick the thread publishes a Snapshot. The render loop draws between the last two, one tick behind, so
+//values move smoothly at any frame rate. Tile edits are queued and applied before the next tick, the simulation
+//is never touched from another thread while it runs.
+
+class SimThread {
+public:
+    enum {CATCH_UP=5}; //ticks run back to back before time is dropped
+
+    //Constructors & Deconstructors
+    SimThread(int threads=0); //threads for the tick's jobs, 0 for one per CPU core
+    ~SimThread(); //Stops the thread
+
+    //Thread
+    bool start(Simulation &sim_, Uint32 interval_); //Ticks sim_ every interval_ milliseconds until stop()
+    void stop(); //Finishes the running tick and stops, sim_ can be used again after
+    void edit(int tile, int type); //The tile changed to type, applied before the next tick
+
+    //Rendering
+    void view(std::shared_ptr<const Simulation::Snapshot> &previous_, std::shared_ptr<const Simulation::Snapshot> &latest_) const; //The last two snapshots, both the same until the second tick
+    float blend(const Simulation::Snapshot &latest_, Uint32 now) const; //How far from the previous snapshot to the latest to draw at now, 0 to 1
+    static float population(const Simulation::Snapshot &previous_, const Simulation::Snapshot &latest_, int settlement, float blend); //Population of a settlement of latest_ between the two
+
+    //Accessors
+    Uint32 returnInterval() const {return interval;}
+    float returnTickTime() const; //Milliseconds the last tick took
+    Uint32 returnDropped() const; //Ticks dropped so far because the thread fell behind
+    bool returnRunning() const {return thread!=NULL;}
+
+private:
+    static int run(void* data); //Thread entry
+    void loop();
+
+    Simulation* sim;
+    ThreadPool pool;
+    SDL_Thread* thread;
+    SDL_mutex* lock; //guards everything below
+    SDL_cond* wake; //signalled by stop()
+    bool quit;
+    Uint32 interval;
+    std::vector<std::pair<int,int> > edits; //tile and type of every queued edit
+    std::shared_ptr<Simulation::Snapshot> previous, latest;
+    float tick_time;
+    Uint32 dropped;
+};
+
+#endif // SIMTHREAD_H
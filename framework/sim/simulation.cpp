@@ -0,0 +1,317 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../core/threadpool.h"
+#include "../interface/tile.h"
+#include "../terrain/terraingrid.h"
+#include "../terrain/tiledatabase.h"
+#include "simulation.h"
+
+Simulation::Simulation() {
+    terrain=NULL;
+    types=NULL;
+    rules.regrow=0.02f;
+    rules.harvest=0.2f;
+    rules.eat=0.1f;
+    rules.growth=0.01f;
+    rules.starve=0.1f;
+    rules.migrate=0.05f;
+    rules.people=0.2f;
+    current=0;
+    ticks=0;
+    layout=0;
+    shared_layout=0;
+    organised=true;
+    region_columns=0;
+}
+
+void Simulation::attach(const TerrainGrid &terrain_, const TileDatabase &types_) {
+    terrain=&terrain_;
+    types=&types_;
+    region_columns=(terrain->returnColumns()+REGION-1)/REGION;
+    int size=terrain->returnSize();
+    tile_capacity.resize(size);
+    for(int i=0;i<size;i++) {
+        tile_capacity[i]=types->returnCapacity(terrain->returnType(i));
+    }
+    owners.assign(size,-1);
+    for(int k=0;k<2;k++) {
+        states[k].resources=tile_capacity;
+        states[k].population.clear();
+        states[k].food.clear();
+    }
+    tiles.clear();
+    capacities.clear();
+    current=0;
+    ticks=0;
+    organised=false;
+}
+
+void Simulation::update(int tile, int type) {
+    float capacity=types->returnCapacity(type);
+    if(organised && owners[tile]!=-1) {
+        capacities[owners[tile]]+=(capacity-tile_capacity[tile])*rules.people;
+    }
+    tile_capacity[tile]=capacity;
+    for(int k=0;k<2;k++) {
+        states[k].resources[tile]=std::min(states[k].resources[tile],tile_capacity[tile]);
+    }
+}
+
+bool Simulation::found(int tile, float population) {
+    if(terrain==NULL || tile<0 || tile>=terrain->returnSize() || owners[tile]!=-1) {
+        return false;
+    }
+    //People live on land they can walk on
+    if(terrain->returnLevel(tile)<=0 || terrain->returnMobility(tile)<=0) {
+        return false;
+    }
+    int settlement=tiles.size();
+    tiles.push_back(tile);
+    states[current].population.push_back(population);
+    states[current].food.push_back(0);
+    owners[tile]=settlement;
+    int neighbours_[TerrainGrid::DIRECTIONS];
+    int count=terrain->neighbours(terrain->returnColumn(tile),terrain->returnRow(tile),neighbours_);
+    for(int k=0;k<count;k++) {
+        if(owners[neighbours_[k]]==-1) {
+            owners[neighbours_[k]]=settlement;
+        }
+    }
+    organised=false;
+    return true;
+}
+
+int Simulation::populate(int count, uint32_t seed, float population) {
+    int founded=0, size=terrain!=NULL ? terrain->returnSize() : 0;
+    for(uint32_t attempt=0;founded<count && size>0 && attempt<(uint32_t)count*20;attempt++) {
+        uint32_t h=seed^(attempt*0x9E3779B1u);
+        h^=h>>16;
+        h*=0x7FEB352Du;
+        h^=h>>15;
+        h*=0x846CA68Bu;
+        h^=h>>16;
+        if(found(h%size,population)) {
+            founded++;
+        }
+    }
+    return founded;
+}
+
+float Simulation::returnTotalPopulation() const {
+    float total=0;
+    for(int s=0;s<(int)states[current].population.size();s++) {
+        total+=states[current].population[s];
+    }
+    return total;
+}
+
+void Simulation::organise() {
+    int count=tiles.size();
+
+    //Region order, the state that changes every tick moves with its settlement
+    std::vector<int> order(count);
+    for(int s=0;s<count;s++) {
+        order[s]=s;
+    }
+    std::sort(order.begin(),order.end(),[this](int a, int b) {
+        int ra=regionOf(tiles[a]), rb=regionOf(tiles[b]);
+        return ra!=rb ? ra<rb : tiles[a]<tiles[b];
+    });
+    State &state=states[current];
+    std::vector<int> sorted_tiles(count);
+    std::vector<float> population(count), food(count);
+    for(int s=0;s<count;s++) {
+        sorted_tiles[s]=tiles[order[s]];
+        population[s]=state.population[order[s]];
+        food[s]=state.food[order[s]];
+    }
+    tiles.swap(sorted_tiles);
+    state.population.swap(population);
+    state.food.swap(food);
+    states[1-current].population.resize(count);
+    states[1-current].food.resize(count);
+
+    //Every settlement works its tile, then the neighbours nobody before it in region order works
+    std::fill(owners.begin(),owners.end(),-1);
+    for(int s=0;s<count;s++) {
+        owners[tiles[s]]=s;
+    }
+    worked_first.assign(count+1,0);
+    worked.clear();
+    capacities.assign(count,0);
+    for(int s=0;s<count;s++) {
+        worked.push_back(tiles[s]);
+        int around[TerrainGrid::DIRECTIONS];
+        int n=terrain->neighbours(terrain->returnColumn(tiles[s]),terrain->returnRow(tiles[s]),around);
+        for(int k=0;k<n;k++) {
+            if(owners[around[k]]==-1) {
+                owners[around[k]]=s;
+                worked.push_back(around[k]);
+            }
+        }
+        worked_first[s+1]=worked.size();
+        for(int k=worked_first[s];k<worked_first[s+1];k++) {
+            capacities[s]+=tile_capacity[worked[k]]*rules.people;
+        }
+    }
+
+    //Neighbours from a grid of RADIUS sized cells, each settlement looks in its own cell and the eight around it
+    int cell_columns=terrain->returnColumns()/RADIUS+1, cell_rows=terrain->returnRows()/RADIUS+1;
+    std::vector<int> cell_first(cell_columns*cell_rows+1,0), cell_settlements(count);
+    for(int s=0;s<count;s++) {
+        cell_first[(terrain->returnRow(tiles[s])/RADIUS)*cell_columns+terrain->returnColumn(tiles[s])/RADIUS+1]++;
+    }
+    for(int c=0;c<cell_columns*cell_rows;c++) {
+        cell_first[c+1]+=cell_first[c];
+    }
+    std::vector<int> filled(cell_first.begin(),cell_first.end()-1);
+    for(int s=0;s<count;s++) {
+        cell_settlements[filled[(terrain->returnRow(tiles[s])/RADIUS)*cell_columns+terrain->returnColumn(tiles[s])/RADIUS]++]=s;
+    }
+    neighbour_first.assign(count+1,0);
+    neighbours.clear();
+    for(int s=0;s<count;s++) {
+        int column=terrain->returnColumn(tiles[s]), row=terrain->returnRow(tiles[s]);
+        for(int cy=std::max(row/RADIUS-1,0);cy<=std::min(row/RADIUS+1,cell_rows-1);cy++) {
+            for(int cx=std::max(column/RADIUS-1,0);cx<=std::min(column/RADIUS+1,cell_columns-1);cx++) {
+                int cell=cy*cell_columns+cx;
+                for(int k=cell_first[cell];k<cell_first[cell+1];k++) {
+                    int other=cell_settlements[k];
+                    if(other!=s && abs(terrain->returnColumn(tiles[other])-column)<=RADIUS && abs(terrain->returnRow(tiles[other])-row)<=RADIUS) {
+                        neighbours.push_back(other);
+                    }
+                }
+            }
+        }
+        neighbour_first[s+1]=neighbours.size();
+    }
+    layout++;
+    organised=true;
+}
+
+void Simulation::snapshot(Snapshot &out) {
+    if(terrain!=NULL && !organised) {
+        organise();
+    }
+    out.tick=ticks;
+    out.time=SDL_GetTicks();
+    out.layout=layout;
+    out.tiles.assign(tiles.begin(),tiles.end());
+    out.population.assign(states[current].population.begin(),states[current].population.end());
+    //Owners only change when settlements are sorted, so one copy serves every snapshot until then
+    if(!shared_owners || shared_layout!=layout) {
+        shared_owners=std::make_shared<std::vector<int> >(owners);
+        shared_layout=layout;
+    }
+    out.owners=shared_owners;
+    out.total=returnTotalPopulation();
+}
+
+void Simulation::tick(ThreadPool &pool) {
+    if(terrain==NULL) {
+        return;
+    }
+    if(!organised) {
+        organise();
+    }
+    int rows=terrain->returnRows();
+    for(int first=0;first<rows;first+=BAND) {
+        int last=std::min(first+(int)BAND,rows);
+        pool.push([this,first,last]() {
+            regrow(first,last);
+        });
+    }
+    pool.wait();
+
+    //Runs of settlements, a few per thread so uneven regions even out, each ending where a region does
+    int count=tiles.size();
+    int jobs=std::max(pool.returnThreads(),1)*4;
+    runs.clear();
+    for(int first=0;first<count;) {
+        int last=std::min(first+std::max(count/jobs,1),count);
+        while(last<count && regionOf(tiles[last])==regionOf(tiles[last-1])) {
+            last++;
+        }
+        runs.push_back(first);
+        first=last;
+    }
+    runs.push_back(count);
+    for(int k=0;k+1<(int)runs.size();k++) {
+        int first=runs[k], last=runs[k+1];
+        pool.push([this,first,last]() {
+            settle(first,last);
+        });
+    }
+    pool.wait();
+    current=1-current;
+    ticks++;
+}
+
+void Simulation::regrow(int first, int last) {
+    const std::vector<float> &now=states[current].resources;
+    std::vector<float> &next=states[1-current].resources;
+    int columns=terrain->returnColumns();
+    for(int i=first*columns;i<last*columns;i++) {
+        next[i]=std::min(now[i]+tile_capacity[i]*rules.regrow,tile_capacity[i]);
+    }
+}
+
+void Simulation::settle(int first, int last) {
+    const State &now=states[current];
+    State &next=states[1-current];
+    for(int s=first;s<last;s++) {
+        //People move from the more crowded of two neighbours to the other. Both work each move out the same way
+        //from the current state, so what one loses the other gains. A settlement never sends more than its share
+        //of its people down a link, so everyone who leaves is there to leave.
+        float crowding=capacities[s]>0 ? now.population[s]/capacities[s] : 1;
+        int links=neighbour_first[s+1]-neighbour_first[s];
+        float left=0, arrived=0;
+        for(int k=neighbour_first[s];k<neighbour_first[s+1];k++) {
+            int other=neighbours[k];
+            float other_crowding=capacities[other]>0 ? now.population[other]/capacities[other] : 1;
+            int other_links=neighbour_first[other+1]-neighbour_first[other];
+            float moved=rules.migrate*(crowding-other_crowding)*std::min(capacities[s],capacities[other])/(1+std::max(links,other_links));
+            if(moved>0) {
+                left+=std::min(moved,now.population[s]/(1+links));
+            }
+            else {
+                arrived+=std::min(-moved,now.population[other]/(1+other_links));
+            }
+        }
+        float population=now.population[s]-left;
+        float food=now.food[s];
+
+        //Harvest from the worked tiles, which no other settlement touches
+        float wanted=population*rules.harvest;
+        for(int k=worked_first[s];k<worked_first[s+1] && wanted>0;k++) {
+            float taken=std::min(next.resources[worked[k]],wanted);
+            next.resources[worked[k]]-=taken;
+            wanted-=taken;
+            food+=taken;
+        }
+
+        //Eat, then grow toward what the land supports or starve
+        food-=population*rules.eat;
+        if(food<0) {
+            float hungry=rules.eat>0 ? -food/rules.eat : population;
+            population-=hungry*rules.starve;
+            food=0;
+        }
+        else if(capacities[s]>0) {
+            population+=population*rules.growth*(1-population/capacities[s]);
+        }
+
+        //Those who arrived this tick eat from next tick on
+        next.population[s]=std::max(population,0.0f)+arrived;
+        next.food[s]=food;
+    }
+}
@@ -0,0 +1,102 @@
+#ifndef SIMULATION_H
+#define SIMULATION_H
+
+//Settlements, their people and the food on every tile, stored as parallel arrays like the TerrainGrid. A settlement
+//works its own tile and the neighbours no other settlement works, so its food never comes from a tile another
+//settlement writes.
+//
+//The state that changes every tick is kept twice. A tick reads the current copy and writes the next one, then the
+//two swap, so every system can run on any number of threads without locks: tiles regrow in bands of rows, then
+//settlements harvest, eat, grow and trade people with their neighbours in runs of map regions. Settlements are kept
+//sorted by region, so each thread walks its own stretch of the arrays.
+//
+//A Snapshot is a copy of what the game shows, taken after a tick and never changed again, so another thread can
+//read it while the next tick runs.
+
+class Simulation {
+public:
+    enum {REGION=64, RADIUS=6, BAND=64}; //REGION*REGION tiles per region, people move between settlements RADIUS tiles apart, BAND rows of tiles per job
+
+    struct Rules {
+        float regrow; //share of a tile's capacity that grows back each tick
+        float harvest; //food one person gathers each tick
+        float eat; //food one person eats each tick
+        float growth; //share the population grows by each tick while fed
+        float starve; //share of the hungry that die each tick
+        float migrate; //share of the difference in crowding that moves between neighbours each tick
+        float people; //people one point of tile capacity supports
+    };
+
+    struct Snapshot {
+        Uint32 tick; //ticks run before it was taken
+        Uint32 time; //SDL_GetTicks() when it was taken
+        Uint32 layout; //settlement s is the same settlement in two snapshots of the same layout
+        std::vector<int> tiles; //per settlement
+        std::vector<float> population; //per settlement
+        std::shared_ptr<const std::vector<int> > owners; //per tile, settlement working it or -1, shared by a layout
+        float total; //people on the map
+    };
+
+    //Constructors & Deconstructors
+    Simulation(); //Default Constructor
+
+    //Map
+    void attach(const TerrainGrid &terrain_, const TileDatabase &types_); //Drops every settlement and fills every tile with food
+    void update(int tile, int type); //The tile changed to type
+    bool found(int tile, float population); //Starts a settlement, false if the tile can't hold people or is worked by another
+    int populate(int count, uint32_t seed, float population); //Founds up to count settlements on random land, returns how many
+
+    //Simulation
+    void tick(ThreadPool &pool); //Advances one tick on the pool, not from a job on it
+    void snapshot(Snapshot &out); //Copies the current state into out, reusing its memory
+
+    //Accessors
+    int returnSettlements() const {return tiles.size();}
+    int returnTile(int settlement) const {return tiles[settlement];}
+    float returnPopulation(int settlement) const {return states[current].population[settlement];}
+    float returnFood(int settlement) const {return states[current].food[settlement];}
+    float returnCapacity(int settlement) const {return capacities[settlement];}
+    float returnResource(int tile) const {return states[current].resources[tile];}
+    int returnOwner(int tile) const {return owners.empty() ? -1 : owners[tile];} //Settlement working a tile, -1 if none
+    float returnTotalPopulation() const;
+    Uint32 returnTicks() const {return ticks;}
+    Rules &returnRules() {return rules;}
+
+private:
+    struct State {
+        std::vector<float> population, food; //per settlement
+        std::vector<float> resources; //per tile, food ready to harvest
+    };
+
+    int regionOf(int tile) const {return (terrain->returnRow(tile)/REGION)*region_columns+terrain->returnColumn(tile)/REGION;}
+    void organise(); //Sorts new settlements into region order and finds their tiles and neighbours
+    void regrow(int first, int last); //Tiles in rows first to last-1
+    void settle(int first, int last); //Settlements first to last-1
+
+    const TerrainGrid* terrain;
+    const TileDatabase* types;
+    Rules rules;
+    State states[2];
+    int current; //the state tick() reads, the other is written
+    Uint32 ticks;
+    Uint32 layout; //counts organise()
+    std::shared_ptr<const std::vector<int> > shared_owners; //owners as of shared_layout, handed to snapshots
+    Uint32 shared_layout;
+    bool organised; //false after found() until the next tick sorts
+    int region_columns;
+
+    //Per tile
+    std::vector<float> tile_capacity; //food a tile holds at most
+    std::vector<int> owners; //settlement working the tile, -1 if none
+
+    //Per settlement, the same in both states
+    std::vector<int> tiles; //where it stands
+    std::vector<float> capacities; //people its tiles support
+    std::vector<int> worked_first; //tiles worked by settlement s are worked[worked_first[s]] to worked[worked_first[s+1]-1]
+    std::vector<int> worked;
+    std::vector<int> neighbour_first; //settlements near s are neighbours[neighbour_first[s]] to neighbours[neighbour_first[s+1]-1]
+    std::vector<int> neighbours;
+    std::vector<int> runs; //first settlement of every job, then the count
+};
+
+#endif // SIMULATION_H
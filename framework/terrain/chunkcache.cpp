@@ -0,0 +1,195 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <memory>
+#include "../render/texturecache.h"
+#include "../render/atlas.h"
+#include "../render/spritebatch.h"
+#include "chunkcache.h"
+
+ChunkCache::ChunkCache() {
+    world_w=0; world_h=0; chunk_size=512; columns=0; rows=0; capacity=0; frame=0;
+}
+
+ChunkCache::~ChunkCache() {
+    clear();
+}
+
+void ChunkCache::init(int world_w_, int world_h_, int chunk_size_, Baker baker_) {
+    clear();
+    world_w=world_w_;
+    world_h=world_h_;
+    chunk_size=chunk_size_;
+    baker=baker_;
+    columns=(world_w+chunk_size-1)/chunk_size;
+    rows=(world_h+chunk_size-1)/chunk_size;
+}
+
+int ChunkCache::chooseLevel(float zoom) {
+    int lod=0;
+    while(lod<LODS-1 && zoom*(2<<lod)<=1.0f) {
+        lod++;
+    }
+    return lod;
+}
+
+void ChunkCache::render(SDL_Renderer* Renderer, SpriteBatch &batch, SDL_Rect camera, float zoom) {
+    frame++;
+    int lod=chooseLevel(zoom);
+    int size=chunk_size<<lod; //world pixels covered by a chunk
+    int lod_columns=(columns+(1<<lod)-1)>>lod, lod_rows=(rows+(1<<lod)-1)>>lod;
+    int first_x=std::max(camera.x,0)/size;
+    int first_y=std::max(camera.y,0)/size;
+    int last_x=std::min((camera.x+camera.w-1)/size,lod_columns-1);
+    int last_y=std::min((camera.y+camera.h-1)/size,lod_rows-1);
+    //Keep the visible chunks plus a ring around them so small camera moves don't re-bake
+    capacity=(camera.w/size+3)*(camera.h/size+3);
+    for(int cy=first_y;cy<=last_y;cy++) {
+        for(int cx=first_x;cx<=last_x;cx++) {
+            std::map<int,Chunk>::iterator it=chunks.find(key(lod,cx,cy));
+            TextureHandle texture;
+            if(it==chunks.end()) {
+                texture=bake(Renderer,lod,cx,cy);
+                if(!texture) {
+                    continue;
+                }
+            }
+            else {
+                texture=it->second.texture;
+                it->second.last_used=frame;
+            }
+            //Only the part of the chunk inside the camera is copied
+            SDL_Rect chunk={cx*size,cy*size,size,size};
+            SDL_Rect visible;
+            if(!SDL_IntersectRect(&chunk,&camera,&visible)) {
+                continue;
+            }
+            SDL_Rect srcrect={(visible.x-chunk.x)>>lod,(visible.y-chunk.y)>>lod,std::max(visible.w>>lod,1),std::max(visible.h>>lod,1)};
+            //Edges are rounded from world coordinates so neighbouring chunks meet without gaps
+            int left=(int)((visible.x-camera.x)*zoom), top=(int)((visible.y-camera.y)*zoom);
+            int right=(int)((visible.x+visible.w-camera.x)*zoom), bottom=(int)((visible.y+visible.h-camera.y)*zoom);
+            SDL_Rect dsrect={left,top,right-left,bottom-top};
+            batch.addTexture(texture.get(),chunk_size,chunk_size,srcrect,dsrect);
+        }
+    }
+    evict();
+}
+
+TextureHandle ChunkCache::bake(SDL_Renderer* Renderer, int lod, int cx, int cy) {
+    TextureHandle texture;
+    //Reuse the texture of the least recently used chunk once the cache is full
+    if((int)chunks.size()>=capacity) {
+        std::map<int,Chunk>::iterator oldest=chunks.end();
+        for(std::map<int,Chunk>::iterator it=chunks.begin();it!=chunks.end();++it) {
+            if(it->second.last_used!=frame && (oldest==chunks.end() || it->second.last_used<oldest->second.last_used)) {
+                oldest=it;
+            }
+        }
+        if(oldest!=chunks.end()) {
+            texture=oldest->second.texture;
+            chunks.erase(oldest);
+        }
+    }
+    if(!texture) {
+        texture=TextureCache::instance().create(Renderer,chunk_size,chunk_size,SDL_TEXTUREACCESS_TARGET);
+        if(!texture) {
+            return texture;
+        }
+    }
+    int size=chunk_size<<lod;
+    SDL_Rect area={cx*size,cy*size,size,size};
+    draw(Renderer,texture.get(),area,area,1<<lod);
+    Chunk chunk={texture,frame};
+    chunks.insert(std::pair<int,Chunk>(key(lod,cx,cy),chunk));
+    return texture;
+}
+
+void ChunkCache::draw(SDL_Renderer* Renderer, SDL_Texture* texture, SDL_Rect chunk, SDL_Rect area, int scale) {
+    //Changing the render target resets the viewport and clip, so they are restored after baking
+    SDL_Rect viewport, clipped;
+    Uint8 r,g,b,a;
+    SDL_RenderGetViewport(Renderer,&viewport);
+    bool clipping=SDL_RenderIsClipEnabled(Renderer);
+    SDL_RenderGetClipRect(Renderer,&clipped);
+    SDL_GetRenderDrawColor(Renderer,&r,&g,&b,&a);
+    SDL_Texture* target=SDL_GetRenderTarget(Renderer);
+    SDL_SetRenderTarget(Renderer,texture);
+    //The baker draws area at 0,0 of the viewport, which is moved to where area is in the chunk and clips to it.
+    //Shrunk chunks are redrawn in whole texture pixels, so area is widened to multiples of scale first.
+    int right=(area.x+area.w-chunk.x+scale-1)/scale, bottom=(area.y+area.h-chunk.y+scale-1)/scale;
+    SDL_Rect local={(area.x-chunk.x)/scale,(area.y-chunk.y)/scale,0,0};
+    local.w=right-local.x;
+    local.h=bottom-local.y;
+    area.x=chunk.x+local.x*scale;
+    area.y=chunk.y+local.y*scale;
+    area.w=local.w*scale;
+    area.h=local.h*scale;
+    SDL_Rect clip={0,0,local.w,local.h};
+    SDL_RenderSetViewport(Renderer,&local);
+    SDL_RenderSetClipRect(Renderer,&clip);
+    SDL_SetRenderDrawColor(Renderer,0,0,0,255);
+    SDL_RenderFillRect(Renderer,NULL);
+    baker(Renderer,area,scale);
+    SDL_RenderSetClipRect(Renderer,NULL);
+    SDL_SetRenderTarget(Renderer,target);
+    SDL_RenderSetViewport(Renderer,&viewport);
+    SDL_RenderSetClipRect(Renderer,clipping ? &clipped : NULL);
+    SDL_SetRenderDrawColor(Renderer,r,g,b,a);
+}
+
+void ChunkCache::redraw(SDL_Renderer* Renderer, SDL_Rect area) {
+    for(std::map<int,Chunk>::iterator it=chunks.begin();it!=chunks.end();++it) {
+        SDL_Rect chunk=this->area(it->first);
+        SDL_Rect part;
+        if(SDL_IntersectRect(&chunk,&area,&part)) {
+            draw(Renderer,it->second.texture.get(),chunk,part,chunk.w/chunk_size);
+        }
+    }
+}
+
+void ChunkCache::evict() {
+    while((int)chunks.size()>capacity) {
+        std::map<int,Chunk>::iterator oldest=chunks.end();
+        for(std::map<int,Chunk>::iterator it=chunks.begin();it!=chunks.end();++it) {
+            if(it->second.last_used==frame) {
+                continue;
+            }
+            if(oldest==chunks.end() || it->second.last_used<oldest->second.last_used) {
+                oldest=it;
+            }
+        }
+        if(oldest==chunks.end()) {
+            return;
+        }
+        chunks.erase(oldest);
+    }
+}
+
+void ChunkCache::invalidate(SDL_Rect area) {
+    std::map<int,Chunk>::iterator it=chunks.begin();
+    while(it!=chunks.end()) {
+        SDL_Rect chunk=this->area(it->first);
+        if(SDL_HasIntersection(&chunk,&area)) {
+            chunks.erase(it++);
+        }
+        else {
+            ++it;
+        }
+    }
+}
+
+SDL_Rect ChunkCache::area(int key) const {
+    int cx=key%columns;
+    int cy=key/columns%rows;
+    int size=chunk_size<<(key/columns/rows);
+    SDL_Rect rect={cx*size,cy*size,size,size};
+    return rect;
+}
+
+void ChunkCache::clear() {
+    chunks.clear();
+}
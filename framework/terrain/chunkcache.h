@@ -0,0 +1,55 @@
+#ifndef CHUNKCACHE_H
+#define CHUNKCACHE_H
+
+//The baked terrain is split into square chunks that are drawn on demand when the camera reaches them.
+//Only the chunks around the camera stay resident, the rest are evicted least recently used first, so
+//memory follows the size of the viewport instead of the size of the map.
+//
+//Zoomed out views use level of detail chunks: a chunk of level k covers chunk_size<<k map pixels baked down into
+//one chunk_size texture. The level is picked so a texture is never shrunk below half size on screen, which keeps
+//the number of chunks drawn, and so the frame time, about the same at every zoom.
+
+class ChunkCache {
+public:
+    typedef std::function<void(SDL_Renderer*, SDL_Rect, int)> Baker; //Draws a world rect shrunk by a scale into the current render target at 0,0, not with the batch render() queues into
+    enum {LODS=4}; //levels of detail, level k is drawn at 1/(1<<k)
+
+    //Constructors & Deconstructors
+    ChunkCache(); //Default Constructor
+    ~ChunkCache(); //Destroys every chunk texture
+
+    //Rendering & Events
+    void init(int world_w, int world_h, int chunk_size_, Baker baker_); //Sets the world size and how chunks are drawn
+    void render(SDL_Renderer* Renderer, SpriteBatch &batch, SDL_Rect camera, float zoom=1.0f); //Queues the camera rect of the world at 0,0 of the batch's viewport, zoom screen pixels per world pixel, baking missing chunks on the way
+    void invalidate(SDL_Rect area); //Drops every chunk touching area, it is baked again when next seen
+    void redraw(SDL_Renderer* Renderer, SDL_Rect area); //Bakes area again inside the resident chunks of every level that touch it
+    void clear(); //Drops every chunk
+
+    //Accessors
+    int returnResident() {return chunks.size();} //Number of baked chunks in memory
+    int returnCapacity() {return capacity;} //Number of chunks kept before evicting
+    int returnChunkSize() {return chunk_size;}
+    static int chooseLevel(float zoom); //Level of detail drawn at a zoom
+
+private:
+    struct Chunk {
+        TextureHandle texture;
+        Uint32 last_used; //frame the chunk was last drawn in
+    };
+
+    TextureHandle bake(SDL_Renderer* Renderer, int lod, int cx, int cy); //Draws one chunk, reusing the least recently used texture
+    void draw(SDL_Renderer* Renderer, SDL_Texture* texture, SDL_Rect chunk, SDL_Rect area, int scale); //Clears and bakes area of a chunk texture
+    int key(int lod, int cx, int cy) const {return (lod*rows+cy)*columns+cx;}
+    SDL_Rect area(int key) const; //World rect covered by a chunk
+    void evict(); //Destroys least recently used chunks not drawn this frame until capacity is met
+
+    std::map<int,Chunk> chunks; //keyed by (lod*rows+cy)*columns+cx
+    Baker baker;
+    int world_w, world_h;
+    int chunk_size;
+    int columns, rows; //level 0 chunks across and down the world
+    int capacity;
+    Uint32 frame;
+};
+
+#endif // CHUNKCACHE_H
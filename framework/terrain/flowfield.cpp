@@ -0,0 +1,251 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <stdint.h>
+#include "../core/threadpool.h"
+#include "terraingrid.h"
+#include "pathfinder.h"
+#include "flowfield.h"
+
+FlowFields::FlowFields(int capacity_) {
+    terrain=NULL;
+    paths=NULL;
+    capacity=capacity_>0 ? capacity_ : 1;
+    clock=0;
+    fields.resize(capacity);
+    clear();
+}
+
+void FlowFields::attach(const TerrainGrid &terrain_, const Pathfinder &paths_) {
+    terrain=&terrain_;
+    paths=&paths_;
+    clear();
+}
+
+void FlowFields::clear() {
+    for(int i=0;i<(int)fields.size();i++) {
+        fields[i].target=-1;
+        fields[i].used=0;
+    }
+}
+
+int FlowFields::find(int target) const {
+    for(int i=0;i<(int)fields.size();i++) {
+        if(fields[i].target==target) {
+            return i;
+        }
+    }
+    return -1;
+}
+
+int FlowFields::returnCached() const {
+    int count=0;
+    for(int i=0;i<(int)fields.size();i++) {
+        if(fields[i].target!=-1) {
+            count++;
+        }
+    }
+    return count;
+}
+
+int FlowFields::slot() {
+    int oldest=0;
+    for(int i=0;i<(int)fields.size();i++) {
+        if(fields[i].target==-1) {
+            return i;
+        }
+        if(fields[i].used<fields[oldest].used) {
+            oldest=i;
+        }
+    }
+    return oldest;
+}
+
+int FlowFields::acquire(int target) {
+    int field=find(target);
+    if(field==-1) {
+        field=slot();
+        build(fields[field],target);
+    }
+    fields[field].used=++clock;
+    return field;
+}
+
+void FlowFields::prepare(const std::vector<int> &targets, ThreadPool &pool) {
+    //Slots are claimed up front so the fields of this call don't evict each other, at most capacity of them
+    std::vector<int> claimed;
+    for(int i=0;i<(int)targets.size() && (int)claimed.size()<capacity;i++) {
+        int field=find(targets[i]);
+        if(field!=-1) {
+            fields[field].used=++clock;
+            continue;
+        }
+        field=slot();
+        fields[field].target=targets[i];
+        fields[field].used=++clock;
+        claimed.push_back(field);
+    }
+    for(int i=0;i<(int)claimed.size();i++) {
+        Field* field=&fields[claimed[i]];
+        pool.push([this,field]() {
+            build(*field,field->target);
+        });
+    }
+    pool.wait();
+}
+
+void FlowFields::update(const std::vector<int> &changed, ThreadPool &pool) {
+    if(changed.empty()) {
+        return;
+    }
+    for(int i=0;i<(int)fields.size();i++) {
+        Field* field=&fields[i];
+        if(field->target!=-1) {
+            pool.push([this,field,&changed]() {
+                repair(*field,changed);
+            });
+        }
+    }
+    pool.wait();
+}
+
+int FlowFields::next(int field, int tile) const {
+    return follow(fields[field],tile);
+}
+
+int FlowFields::follow(const Field &field, int tile) const {
+    int direction=field.direction[tile];
+    if(direction==NONE) {
+        return -1;
+    }
+    return terrain->neighbour(terrain->returnColumn(tile),terrain->returnRow(tile),direction);
+}
+
+void FlowFields::build(Field &field, int target) {
+    int size=terrain->returnSize();
+    field.target=target;
+    field.cost.assign(size,UNREACHED);
+    field.direction.assign(size,NONE);
+    field.affected.assign(size,0);
+    field.open.reserve(size);
+    field.touched.clear();
+    field.open.clear();
+    field.cost[target]=0;
+    field.open.push_back(std::make_pair(0u,target));
+    spread(field,false);
+    for(int i=0;i<size;i++) {
+        point(field,i);
+    }
+}
+
+void FlowFields::repair(Field &field, const std::vector<int> &changed) {
+    //Every tile whose flow runs through a changed tile loses its cost, the rest of the field still holds
+    std::vector<int> &touched=field.touched;
+    touched.clear();
+    for(int i=0;i<(int)changed.size();i++) {
+        if(!field.affected[changed[i]]) {
+            field.affected[changed[i]]=1;
+            touched.push_back(changed[i]);
+        }
+    }
+    for(int k=0;k<(int)touched.size();k++) {
+        int tile=touched[k];
+        int column=terrain->returnColumn(tile), row=terrain->returnRow(tile);
+        for(int direction=0;direction<TerrainGrid::DIRECTIONS;direction++) {
+            int from=terrain->neighbour(column,row,direction);
+            if(from!=-1 && !field.affected[from] && follow(field,from)==tile) {
+                field.affected[from]=1;
+                touched.push_back(from);
+            }
+        }
+    }
+    int affected=touched.size();
+    for(int k=0;k<affected;k++) {
+        field.cost[touched[k]]=UNREACHED;
+    }
+
+    //They start again from their cheapest neighbour that kept its cost
+    field.open.clear();
+    for(int k=0;k<affected;k++) {
+        int tile=touched[k];
+        uint32_t best=tile==field.target ? 0 : (uint32_t)UNREACHED;
+        int column=terrain->returnColumn(tile), row=terrain->returnRow(tile);
+        for(int direction=0;direction<TerrainGrid::DIRECTIONS && best!=0;direction++) {
+            int to=terrain->neighbour(column,row,direction);
+            if(to==-1 || field.affected[to] || field.cost[to]==UNREACHED) {
+                continue;
+            }
+            int step=paths->step(tile,to);
+            if(step!=Pathfinder::BLOCKED) {
+                best=std::min(best,field.cost[to]+step);
+            }
+        }
+        if(best!=UNREACHED) {
+            field.cost[tile]=best;
+            field.open.push_back(std::make_pair(best,tile));
+        }
+    }
+    std::make_heap(field.open.begin(),field.open.end(),std::greater<std::pair<uint32_t,int> >());
+    spread(field,true);
+
+    //spread() added every tile it lowered, only those and the affected tiles can point somewhere new
+    for(int k=0;k<(int)touched.size();k++) {
+        point(field,touched[k]);
+    }
+    for(int k=0;k<affected;k++) {
+        field.affected[touched[k]]=0;
+    }
+}
+
+void FlowFields::spread(Field &field, bool track) {
+    std::greater<std::pair<uint32_t,int> > lowest;
+    while(!field.open.empty()) {
+        std::pair<uint32_t,int> top=field.open.front();
+        std::pop_heap(field.open.begin(),field.open.end(),lowest);
+        field.open.pop_back();
+        int tile=top.second;
+        if(top.first>field.cost[tile]) {
+            continue; //lowered again after this was queued
+        }
+        int column=terrain->returnColumn(tile), row=terrain->returnRow(tile);
+        for(int direction=0;direction<TerrainGrid::DIRECTIONS;direction++) {
+            int from=terrain->neighbour(column,row,direction);
+            if(from==-1) {
+                continue;
+            }
+            int step=paths->step(from,tile);
+            if(step==Pathfinder::BLOCKED || top.first+step>=field.cost[from]) {
+                continue;
+            }
+            if(track && !field.affected[from]) {
+                field.touched.push_back(from);
+            }
+            field.cost[from]=top.first+step;
+            field.open.push_back(std::make_pair(field.cost[from],from));
+            std::push_heap(field.open.begin(),field.open.end(),lowest);
+        }
+    }
+}
+
+void FlowFields::point(Field &field, int tile) {
+    field.direction[tile]=NONE;
+    if(tile==field.target || field.cost[tile]==UNREACHED) {
+        return;
+    }
+    uint32_t best=UNREACHED;
+    int column=terrain->returnColumn(tile), row=terrain->returnRow(tile);
+    for(int direction=0;direction<TerrainGrid::DIRECTIONS;direction++) {
+        int to=terrain->neighbour(column,row,direction);
+        if(to==-1 || field.cost[to]==UNREACHED) {
+            continue;
+        }
+        int step=paths->step(tile,to);
+        if(step!=Pathfinder::BLOCKED && field.cost[to]+step<best) {
+            best=field.cost[to]+step;
+            field.direction[tile]=direction;
+        }
+    }
+}
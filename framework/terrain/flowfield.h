@@ -0,0 +1,64 @@
+#ifndef FLOWFIELD_H
+#define FLOWFIELD_H
+
+//Flow fields for many units heading to the same tile. A field holds the cost from every tile to its target and the
+//direction of the cheapest step from each tile, so a unit finds its next tile with one lookup however many units
+//share the field. Costs are the Pathfinder's, mobility and climbing included.
+//
+//Fields are cached per target, least recently used dropped first. Fields missing from a set of targets are built
+//at once, one per worker thread. When tiles change, only the tiles whose flow ran through them are worked out again
+//in every cached field, instead of the whole field.
+
+class FlowFields {
+public:
+    enum {UNREACHED=0xFFFFFFFF, NONE=0xFF}; //cost of tiles that can't reach the target, direction of the target and those tiles
+
+    //Constructors & Deconstructors
+    FlowFields(int capacity_=16); //Keeps up to capacity_ fields
+
+    //Map
+    void attach(const TerrainGrid &terrain_, const Pathfinder &paths_); //Drops every field, paths_ gives the step costs
+    void update(const std::vector<int> &changed, ThreadPool &pool); //Repairs every field after tiles changed, after Pathfinder::update, not from a job on pool
+
+    //Fields
+    int acquire(int target); //Field leading to target, built now if it isn't cached
+    void prepare(const std::vector<int> &targets, ThreadPool &pool); //Builds the fields of targets that aren't cached in parallel, not from a job on pool
+    int find(int target) const; //Cached field leading to target, -1 if there is none
+    void clear(); //Drops every field
+
+    //Following
+    int next(int field, int tile) const; //Tile to step to, -1 at the target or where the target can't be reached
+    uint32_t returnCost(int field, int tile) const {return fields[field].cost[tile];}
+    int returnDirection(int field, int tile) const {return fields[field].direction[tile];}
+    int returnTarget(int field) const {return fields[field].target;}
+
+    //Accessors
+    int returnCapacity() const {return capacity;}
+    int returnCached() const; //Number of fields holding a target
+
+private:
+    struct Field {
+        int target; //-1 if the slot is free
+        Uint32 used; //when it was last acquired
+        std::vector<uint32_t> cost; //per tile, cost of the cheapest path to the target
+        std::vector<uint8_t> direction; //per tile, direction of the first step of that path
+        std::vector<uint8_t> affected; //per tile, scratch for repairs
+        std::vector<std::pair<uint32_t,int> > open; //binary heap of the frontier, lowest cost first
+        std::vector<int> touched; //scratch for repairs
+    };
+
+    int slot(); //A free slot, or the least recently used one
+    void build(Field &field, int target); //Integrates the whole field from its target
+    void repair(Field &field, const std::vector<int> &changed); //Works out again the tiles whose flow ran through changed
+    void spread(Field &field, bool track); //Dijkstra out of the open heap, track adds the tiles it lowers to touched
+    int follow(const Field &field, int tile) const; //next() for a field
+    void point(Field &field, int tile); //Sets the direction of a tile to its cheapest neighbour
+
+    const TerrainGrid* terrain;
+    const Pathfinder* paths;
+    int capacity;
+    Uint32 clock; //counts acquires, for least recently used
+    std::vector<Field> fields;
+};
+
+#endif // FLOWFIELD_H
@@ -0,0 +1,278 @@
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+#include "../interface/tile.h"
+#include "terraingrid.h"
+#include "tiledatabase.h"
+#include "mapfile.h"
+
+static const char map_magic[4] = {'S','M','A','P'};
+
+//Converts a value between the file's little endian order and the host's, it is the same swap both ways
+static uint32_t little_endian(uint32_t value) {
+    const uint16_t probe=1;
+    if(*(const uint8_t*)&probe==1) {
+        return value;
+    }
+    return (value>>24)|((value>>8)&0xFF00)|((value<<8)&0xFF0000)|(value<<24);
+}
+
+static void convert_header(MapHeader &header) {
+    header.version=little_endian(header.version);
+    header.columns=little_endian(header.columns);
+    header.rows=little_endian(header.rows);
+    header.legend_count=little_endian(header.legend_count);
+    header.legend_offset=little_endian(header.legend_offset);
+    header.payload_offset=little_endian(header.payload_offset);
+    header.seed=little_endian(header.seed);
+}
+
+MapFile::MapFile() {
+    data=NULL;
+    size=0;
+    memset(&header,0,sizeof(header));
+#ifdef _WIN32
+    file=INVALID_HANDLE_VALUE;
+    mapping=NULL;
+#else
+    file=-1;
+#endif
+}
+
+MapFile::~MapFile() {
+    close();
+}
+
+bool MapFile::open(std::string path) {
+    close();
+#ifdef _WIN32
+    file=CreateFileA(path.c_str(),GENERIC_READ,FILE_SHARE_READ,NULL,OPEN_EXISTING,FILE_FLAG_SEQUENTIAL_SCAN,NULL);
+    if(file==INVALID_HANDLE_VALUE) {
+        printf("Can't open %s.\n",path.c_str());
+        return false;
+    }
+    LARGE_INTEGER file_size;
+    GetFileSizeEx(file,&file_size);
+    size=file_size.QuadPart;
+    mapping=CreateFileMappingA(file,NULL,PAGE_READONLY,0,0,NULL);
+    if(mapping!=NULL) {
+        data=(const char*)MapViewOfFile(mapping,FILE_MAP_READ,0,0,0);
+    }
+#else
+    file=::open(path.c_str(),O_RDONLY);
+    if(file==-1) {
+        printf("Can't open %s.\n",path.c_str());
+        return false;
+    }
+    struct stat info;
+    fstat(file,&info);
+    size=info.st_size;
+    void* mapped=mmap(NULL,size,PROT_READ,MAP_PRIVATE,file,0);
+    if(mapped!=MAP_FAILED) {
+        data=(const char*)mapped;
+        madvise(mapped,size,MADV_SEQUENTIAL);
+    }
+#endif
+    if(data==NULL) {
+        printf("Can't map %s into memory.\n",path.c_str());
+        close();
+        return false;
+    }
+    //Check that the header and everything it points to lies inside the file
+    memset(&header,0,sizeof(header));
+    if(size>=sizeof(MapHeader)) {
+        memcpy(&header,data,sizeof(header));
+        convert_header(header);
+    }
+    uint64_t tiles=(uint64_t)header.columns*header.rows;
+    if(size<sizeof(MapHeader) || memcmp(header.magic,map_magic,4)!=0 || header.version!=VERSION || header.legend_count>256 ||
+       tiles>0x7FFFFFFF || header.legend_offset+(uint64_t)header.legend_count*LEGEND_NAME>size || header.payload_offset+tiles*3>size) {
+        printf("%s is not a valid version %d map.\n",path.c_str(),VERSION);
+        close();
+        return false;
+    }
+    return true;
+}
+
+void MapFile::close() {
+#ifdef _WIN32
+    if(data!=NULL) {
+        UnmapViewOfFile(data);
+    }
+    if(mapping!=NULL) {
+        CloseHandle(mapping);
+    }
+    if(file!=INVALID_HANDLE_VALUE) {
+        CloseHandle(file);
+    }
+    mapping=NULL;
+    file=INVALID_HANDLE_VALUE;
+#else
+    if(data!=NULL) {
+        munmap((void*)data,size);
+    }
+    if(file!=-1) {
+        ::close(file);
+    }
+    file=-1;
+#endif
+    data=NULL;
+    size=0;
+}
+
+std::string MapFile::returnLegendName(int id) const {
+    const char* name=data+header.legend_offset+id*LEGEND_NAME;
+    return std::string(name,strnlen(name,LEGEND_NAME));
+}
+
+bool MapFile::load(const TileDatabase &types, TerrainGrid &grid) const {
+    if(data==NULL) {
+        return false;
+    }
+    int tiles=header.columns*header.rows;
+    //Only the legend is looked up by name. Ids outside the legend map to -1, which stops the load.
+    int16_t remap[256];
+    uint8_t mobility[256];
+    for(int id=0;id<256;id++) {
+        remap[id]=-1;
+        mobility[id]=0;
+    }
+    for(int id=0;id<(int)header.legend_count;id++) {
+        int type=types.find(returnLegendName(id));
+        if(type==-1) {
+            printf("Unknown tile %s in map.\n",returnLegendName(id).c_str());
+            return false;
+        }
+        remap[id]=type;
+    }
+    for(int id=0;id<types.returnCount();id++) {
+        mobility[id]=types.returnMobility(id);
+    }
+    const uint8_t* payload=(const uint8_t*)(data+header.payload_offset);
+    int bad=grid.assign(header.columns,header.rows,payload,payload+tiles,(const int8_t*)(payload+2*tiles),remap,mobility);
+    if(bad!=-1) {
+        printf("Tile %d of the map has type %d, the legend only has %u.\n",bad,payload[bad],(unsigned)header.legend_count);
+        grid.resize(0,0);
+        return false;
+    }
+    return true;
+}
+
+bool MapFile::write(std::string path, const TerrainGrid &grid, const TileDatabase &types, uint32_t seed) {
+    std::ofstream out(path.c_str(),std::ios::binary);
+    if(!out.good()) {
+        printf("Can't write %s.\n",path.c_str());
+        return false;
+    }
+    MapHeader header;
+    memset(&header,0,sizeof(header));
+    memcpy(header.magic,map_magic,4);
+    header.version=VERSION;
+    header.seed=seed;
+    header.columns=grid.returnColumns();
+    header.rows=grid.returnRows();
+    header.legend_count=types.returnCount();
+    header.legend_offset=sizeof(MapHeader);
+    header.payload_offset=header.legend_offset+header.legend_count*LEGEND_NAME;
+    convert_header(header);
+    out.write((const char*)&header,sizeof(header));
+    for(int id=0;id<types.returnCount();id++) {
+        char name[LEGEND_NAME];
+        memset(name,0,LEGEND_NAME);
+        strncpy(name,types.returnName(id).c_str(),LEGEND_NAME);
+        out.write(name,LEGEND_NAME);
+    }
+    if(grid.returnSize()>0) {
+        out.write((const char*)grid.returnTypeRow(0),grid.returnSize());
+        out.write((const char*)grid.returnVariantRow(0),grid.returnSize());
+        out.write((const char*)grid.returnLevelRow(0),grid.returnSize());
+    }
+    return out.good();
+}
+
+bool MapFile::parseText(std::string path, const TileDatabase &types, uint32_t seed, TerrainGrid &grid) {
+    int w, h;
+    std::ifstream map(path.c_str());
+    if (!map.good()) {
+        printf("Can't open %s.\n",path.c_str());
+        return false;
+    }
+    int column=0;int row=0;
+    std::map<int,int> maps; //legend number -> tile type id
+    std::string value,name;
+    map >> w;
+    map >> h;
+    grid.resize(w,h);
+    while(map >> value) {
+        if(value[0]=='>') {
+            value.replace(value.begin(),value.begin()+1,"");
+            name=value;
+            map>>value;
+            int type=types.find(value);
+            if(type==-1) {
+                printf("Unknown tile %s in map.\n",value.c_str());
+                return false;
+            }
+            maps.insert(std::pair<int,int>(std::atoi(name.c_str()),type));
+        }
+        else if(value!="/") {
+            if(column<w && row<h) {
+                std::map<int,int>::iterator legend=maps.find(std::atoi(value.c_str()));
+                if(legend==maps.end()) {
+                    printf("Tile %s is not in the legend.\n",value.c_str());
+                    return false;
+                }
+                int id=legend->second;
+                grid.setTile(column,row,id,TerrainGrid::variantFor(seed,column,row,id),types.returnLevel(id),types.returnMobility(id));
+            }
+            column++;
+        }
+        else {
+            column=0;
+            row++;
+        }
+    }
+    return true;
+}
+
+bool MapFile::writeText(std::string path, const TerrainGrid &grid, const TileDatabase &types) {
+    std::ofstream map(path.c_str());
+    if(!map.good()) {
+        printf("Can't write %s.\n",path.c_str());
+        return false;
+    }
+    map<<grid.returnColumns()<<" "<<grid.returnRows()<<"\n";
+    for(int id=0;id<types.returnCount();id++) {
+        map<<">"<<id<<" "<<types.returnName(id)<<"\n";
+    }
+    for(int row=0;row<grid.returnRows();row++) {
+        const uint8_t* tiles=grid.returnTypeRow(row);
+        for(int column=0;column<grid.returnColumns();column++) {
+            map<<(int)tiles[column]<<" ";
+        }
+        map<<"/\n";
+    }
+    return map.good();
+}
+
+bool MapFile::isBinary(std::string path) {
+    std::ifstream in(path.c_str(),std::ios::binary);
+    char magic[4];
+    if(!in.read(magic,4)) {
+        return false;
+    }
+    return memcmp(magic,map_magic,4)==0;
+}
@@ -0,0 +1,61 @@
+#ifndef MAPFILE_H
+#define MAPFILE_H
+
+//Maps come in two formats, told apart by the first four bytes of the file.
+//
+//Text maps (map.map) are "columns rows", a legend of ">number name" lines and then one number per tile with
+//a "/" at the end of every row.
+//
+//Binary maps start with a MapHeader, followed by the legend and the payload:
+//  legend   legend_count names of LEGEND_NAME bytes each, entry i is the name of type id i in the payload
+//  payload  columns*rows type ids, then as many variants, then as many levels, one byte per tile in row order
+//Header values are little endian, the payload is single bytes. The file is mapped into memory and nothing is parsed
+//per tile: loading copies the variants and levels straight in and makes one pass over the types, which checks them
+//against the legend, converts them to database ids and sets the mobility of every tile.
+
+struct MapHeader {
+    char magic[4]; //"SMAP"
+    uint32_t version;
+    uint32_t columns, rows;
+    uint32_t legend_count;
+    uint32_t legend_offset; //bytes from the start of the file
+    uint32_t payload_offset; //bytes from the start of the file
+    uint32_t seed; //seed the variants were picked with
+};
+
+class MapFile {
+public:
+    enum {VERSION=1, LEGEND_NAME=32};
+
+    //Constructors & Deconstructors
+    MapFile(); //Default Constructor
+    ~MapFile(); //Unmaps the file
+
+    //Binary maps
+    bool open(std::string path); //Maps a binary map into memory and checks its header
+    void close(); //Unmaps the file
+    bool load(const TileDatabase &types, TerrainGrid &grid) const; //Copies the open map into grid, converting its legend to database ids, fails on ids outside the legend
+    static bool write(std::string path, const TerrainGrid &grid, const TileDatabase &types, uint32_t seed=0); //Writes grid as a binary map
+
+    //Text maps
+    static bool parseText(std::string path, const TileDatabase &types, uint32_t seed, TerrainGrid &grid); //Variants are picked from seed
+    static bool writeText(std::string path, const TerrainGrid &grid, const TileDatabase &types); //Writes grid as a text map, the legend is every type id
+
+    //Accessors
+    static bool isBinary(std::string path); //True if the file starts with the binary map magic
+    const MapHeader* returnHeader() const {return &header;} //In host byte order
+    std::string returnLegendName(int id) const; //Name of a type id used in the payload
+
+private:
+    const char* data; //the mapped file
+    MapHeader header; //read from data by open()
+    size_t size;
+#ifdef _WIN32
+    void* file;
+    void* mapping;
+#else
+    int file;
+#endif
+};
+
+#endif // MAPFILE_H
@@ -0,0 +1,179 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <memory>
+#include <stdint.h>
+#include "../core/threadpool.h"
+#include "../render/texturecache.h"
+#include "../render/atlas.h"
+#include "../render/spritebatch.h"
+#include "terraingrid.h"
+#include "picking.h"
+#include "minimap.h"
+
+Minimap::Minimap() {
+    for(int i=0;i<LEVELS;i++) {
+        levels[i].w=0;
+        levels[i].h=0;
+    }
+    finest=LEVELS;
+}
+
+Minimap::~Minimap() {
+    free();
+}
+
+bool Minimap::build(const TerrainGrid &terrain, const HexPicker &picker, const std::vector<Uint32> &colours, int world_w, int world_h, ThreadPool &pool, int max_size) {
+    free();
+    for(int i=0;i<LEVELS;i++) {
+        levels[i].w=std::max(world_w/returnScale(i),1);
+        levels[i].h=std::max(world_h/returnScale(i),1);
+        if(finest==LEVELS && levels[i].w<=max_size && levels[i].h<=max_size) {
+            finest=i;
+        }
+    }
+    if(finest==LEVELS) {
+        printf("The map is too big for a minimap.\n");
+        return false;
+    }
+    for(int i=finest;i<LEVELS;i++) {
+        levels[i].pixels.resize(levels[i].w*levels[i].h);
+    }
+    //Each level needs the whole level before it, so the bands of one level finish before the next one starts
+    for(int i=finest;i<LEVELS;i++) {
+        for(int y=0;y<levels[i].h;y+=BAND) {
+            SDL_Rect rect={0,y,levels[i].w,std::min((int)BAND,levels[i].h-y)};
+            pool.push([this,&terrain,&picker,&colours,i,rect]() {
+                if(i==finest) {
+                    rasterise(terrain,picker,colours,i,rect);
+                }
+                else {
+                    reduce(i,rect);
+                }
+            });
+        }
+        pool.wait();
+    }
+    return true;
+}
+
+void Minimap::rasterise(const TerrainGrid &terrain, const HexPicker &picker, const std::vector<Uint32> &colours, int level, SDL_Rect rect) {
+    //Every pixel takes the colour of the tile under its centre
+    Level &l=levels[level];
+    int scale=returnScale(level);
+    for(int y=rect.y;y<rect.y+rect.h;y++) {
+        Uint32* pixels=&l.pixels[y*l.w];
+        for(int x=rect.x;x<rect.x+rect.w;x++) {
+            int column, row;
+            picker.cell(x*scale+scale/2,y*scale+scale/2,column,row);
+            Uint32 argb=terrain.contains(column,row) ? colours[terrain.returnType(column,row)] : 0xFF000000;
+            pixels[x]=argb<<8|argb>>24;
+        }
+    }
+}
+
+void Minimap::reduce(int level, SDL_Rect rect) {
+    Level &l=levels[level];
+    const Level &above=levels[level-1];
+    for(int y=rect.y;y<rect.y+rect.h;y++) {
+        for(int x=rect.x;x<rect.x+rect.w;x++) {
+            Uint32 sum[4]={0,0,0,0};
+            for(int i=0;i<4;i++) {
+                int sx=std::min(x*2+i%2,above.w-1), sy=std::min(y*2+i/2,above.h-1);
+                Uint32 pixel=above.pixels[sy*above.w+sx];
+                for(int c=0;c<4;c++) {
+                    sum[c]+=(pixel>>(c*8))&255;
+                }
+            }
+            l.pixels[y*l.w+x]=(sum[3]/4)<<24|(sum[2]/4)<<16|(sum[1]/4)<<8|(sum[0]/4);
+        }
+    }
+}
+
+bool Minimap::upload(SDL_Renderer* Renderer) {
+    for(int i=finest;i<LEVELS;i++) {
+        levels[i].texture=TextureCache::instance().create(Renderer,levels[i].w,levels[i].h,SDL_TEXTUREACCESS_STATIC);
+        if(!levels[i].texture) {
+            return false;
+        }
+        SDL_UpdateTexture(levels[i].texture.get(),NULL,&levels[i].pixels[0],levels[i].w*4);
+    }
+    return finest<LEVELS;
+}
+
+void Minimap::update(const TerrainGrid &terrain, const HexPicker &picker, const std::vector<Uint32> &colours, SDL_Rect area) {
+    for(int i=finest;i<LEVELS;i++) {
+        //The pixels whose centres can fall in area, plus the ones averaged from them on coarser levels
+        int scale=returnScale(i);
+        int x0=std::max(area.x/scale,0), y0=std::max(area.y/scale,0);
+        int x1=std::min((area.x+area.w)/scale+1,levels[i].w), y1=std::min((area.y+area.h)/scale+1,levels[i].h);
+        if(x0>=x1 || y0>=y1) {
+            continue;
+        }
+        SDL_Rect rect={x0,y0,x1-x0,y1-y0};
+        if(i==finest) {
+            rasterise(terrain,picker,colours,i,rect);
+        }
+        else {
+            reduce(i,rect);
+        }
+        if(levels[i].texture) {
+            SDL_UpdateTexture(levels[i].texture.get(),&rect,&levels[i].pixels[y0*levels[i].w+x0],levels[i].w*4);
+        }
+    }
+}
+
+void Minimap::render(SpriteBatch &batch, int level, SDL_Rect pane, SDL_Rect camera) {
+    if(level<finest || level>=LEVELS || !levels[level].texture) {
+        return;
+    }
+    Level &l=levels[level];
+    int scale=returnScale(level);
+    SDL_Rect selector={camera.x/scale,camera.y/scale,camera.w/scale,camera.h/scale};
+    //Scroll the level when it is bigger than the pane so the selector stays inside
+    SDL_Rect srcrect={0,0,std::min(pane.w,l.w),std::min(pane.h,l.h)};
+    if(selector.x+selector.w>srcrect.w) {
+        srcrect.x=std::min(selector.x+selector.w-srcrect.w,l.w-srcrect.w);
+    }
+    if(selector.y+selector.h>srcrect.h) {
+        srcrect.y=std::min(selector.y+selector.h-srcrect.h,l.h-srcrect.h);
+    }
+    selector.x-=srcrect.x;
+    selector.y-=srcrect.y;
+    SDL_Rect dsrect={pane.x,pane.y,srcrect.w,srcrect.h};
+    selector.x+=pane.x;
+    selector.y+=pane.y;
+    batch.addTexture(l.texture.get(),l.w,l.h,srcrect,dsrect);
+    //The camera outline, one pixel wide like SDL_RenderDrawRect
+    SDL_Color white={255,255,255,255};
+    SDL_Rect top={selector.x,selector.y,selector.w,1}, bottom={selector.x,selector.y+selector.h-1,selector.w,1};
+    SDL_Rect left={selector.x,selector.y,1,selector.h}, right={selector.x+selector.w-1,selector.y,1,selector.h};
+    batch.addRect(top,white);
+    batch.addRect(bottom,white);
+    batch.addRect(left,white);
+    batch.addRect(right,white);
+}
+
+int Minimap::choose(int w, int h) const {
+    for(int i=finest;i<LEVELS;i++) {
+        if(levels[i].w<=w && levels[i].h<=h) {
+            return i;
+        }
+    }
+    return LEVELS-1;
+}
+
+void Minimap::free() {
+    for(int i=0;i<LEVELS;i++) {
+        levels[i].pixels.clear();
+        levels[i].texture.reset();
+        levels[i].w=0;
+        levels[i].h=0;
+    }
+    finest=LEVELS;
+}
@@ -0,0 +1,47 @@
+#ifndef MINIMAP_H
+#define MINIMAP_H
+
+//The minimap as a pyramid of images made straight from the terrain grid, one colour per tile type. Level 0 is 1/5
+//of the map, every level after it half the size of the one before. The finest level that fits in a texture is
+//rasterised from the tiles in bands of rows on worker threads, the coarser levels are averaged from it.
+
+class Minimap {
+public:
+    enum {SCALE=5, LEVELS=8, BAND=64}; //level k is 1/(SCALE<<k) of the map, BAND rows are one job
+
+    //Constructors & Deconstructors
+    Minimap(); //Default Constructor
+    ~Minimap(); //Destroys the level textures
+
+    //Rendering & Events
+    bool build(const TerrainGrid &terrain, const HexPicker &picker, const std::vector<Uint32> &colours, int world_w, int world_h, ThreadPool &pool, int max_size=4096); //Rasterises every level, colours holds the ARGB colour of every tile type
+    bool upload(SDL_Renderer* Renderer); //Creates the level textures, on the main thread
+    void update(const TerrainGrid &terrain, const HexPicker &picker, const std::vector<Uint32> &colours, SDL_Rect area); //Rasterises area (in map pixels) again in every level and its texture
+    void render(SpriteBatch &batch, int level, SDL_Rect pane, SDL_Rect camera); //Queues a level into pane, scrolled so the camera outline is in view
+
+    //Accessors
+    int choose(int w, int h) const; //Finest built level that fits in w*h, or the coarsest one
+    bool returnBuilt(int level) const {return !levels[level].pixels.empty();}
+    int returnScale(int level) const {return SCALE<<level;}
+    int returnWidth(int level) const {return levels[level].w;}
+    int returnHeight(int level) const {return levels[level].h;}
+    SDL_Texture* returnTexture(int level) const {return levels[level].texture.get();}
+
+    //Miscellaneous
+    void free(); //Forgets every level
+
+private:
+    struct Level {
+        int w, h;
+        std::vector<Uint32> pixels; //RGBA8888, empty if the level is too big to build
+        TextureHandle texture;
+    };
+
+    void rasterise(const TerrainGrid &terrain, const HexPicker &picker, const std::vector<Uint32> &colours, int level, SDL_Rect rect); //Fills rect (in level pixels) from the tiles
+    void reduce(int level, SDL_Rect rect); //Fills rect (in level pixels) by averaging the level before
+
+    Level levels[LEVELS];
+    int finest; //first built level, LEVELS if none is
+};
+
+#endif // MINIMAP_H
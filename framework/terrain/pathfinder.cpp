@@ -0,0 +1,594 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <vector>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <stdint.h>
+#include <stdlib.h>
+#include "../core/threadpool.h"
+#include "terraingrid.h"
+#include "pathfinder.h"
+
+//Orders the open heap so the lowest estimate is on top
+static bool open_after(const Pathfinder::Search::Open &a, const Pathfinder::Search::Open &b) {
+    return a.f>b.f;
+}
+
+void Pathfinder::Search::prepare(int tiles, int nodes) {
+    if((int)cost.size()<tiles) {
+        cost.resize(tiles);
+        parent.resize(tiles);
+        seen.resize(tiles,0);
+        open.reserve(tiles);
+    }
+    if((int)node_cost.size()<nodes) {
+        node_cost.resize(nodes);
+        node_parent.resize(nodes);
+        node_seen.resize(nodes,0);
+    }
+}
+
+void Pathfinder::Search::next() {
+    generation+=2;
+    if(generation<2) {
+        //Wrapped around, a stamp left from four billion queries ago could look current
+        std::fill(seen.begin(),seen.end(),0);
+        std::fill(node_seen.begin(),node_seen.end(),0);
+        generation=2;
+    }
+    open.clear();
+}
+
+Pathfinder::Pathfinder() {
+    terrain=NULL;
+    costs.climb=50;
+    costs.descend=10;
+    costs.max_step=2;
+    cheapest=1;
+    built=false;
+    cluster_columns=0;
+    cluster_rows=0;
+}
+
+void Pathfinder::attach(const TerrainGrid &terrain_, Costs costs_) {
+    terrain=&terrain_;
+    costs=costs_;
+    built=false;
+    enter.resize(terrain->returnSize());
+    cheapest=BLOCKED;
+    for(int i=0;i<terrain->returnSize();i++) {
+        price(i);
+    }
+}
+
+void Pathfinder::price(int i) {
+    int mobility=terrain->returnMobility(i);
+    enter[i]=mobility<=0 ? (int)BLOCKED : std::min((100*100+mobility/2)/mobility,BLOCKED-1);
+    if(enter[i]<cheapest) {
+        cheapest=enter[i];
+    }
+}
+
+void Pathfinder::update(int i) {
+    update(std::vector<int>(1,i));
+}
+
+void Pathfinder::update(const std::vector<int> &changed) {
+    for(int k=0;k<(int)changed.size();k++) {
+        price(changed[k]);
+    }
+    if(!built || changed.empty()) {
+        return;
+    }
+
+    //A tile only changes the gaps out of its own cluster and the costs across it, but the clusters around share those
+    //gaps, so their nodes can move too
+    std::vector<int> dirty;
+    for(int k=0;k<(int)changed.size();k++) {
+        int cluster=clusterOf(changed[k]);
+        int column=cluster%cluster_columns, row=cluster/cluster_columns;
+        for(int r=std::max(row-1,0);r<=std::min(row+1,cluster_rows-1);r++) {
+            for(int c=std::max(column-1,0);c<=std::min(column+1,cluster_columns-1);c++) {
+                dirty.push_back(r*cluster_columns+c);
+            }
+        }
+    }
+    std::sort(dirty.begin(),dirty.end());
+    dirty.erase(std::unique(dirty.begin(),dirty.end()),dirty.end());
+
+    std::vector<Transition> transitions;
+    for(int k=0;k<(int)dirty.size();k++) {
+        placeCrossings(dirty[k],transitions,crossings[dirty[k]]);
+    }
+    collectNodes();
+    if(searches.empty()) {
+        searches.resize(1);
+    }
+    Search &s=searches[0];
+    s.prepare(terrain->returnSize(),0);
+    for(int k=0;k<(int)dirty.size();k++) {
+        linkCluster(s,dirty[k],inside[dirty[k]]);
+    }
+    collectEdges();
+}
+
+int Pathfinder::step(int from, int to) const {
+    if(enter[to]==BLOCKED) {
+        return BLOCKED;
+    }
+    int climb=terrain->returnLevel(to)-terrain->returnLevel(from);
+    if(abs(climb)>costs.max_step) {
+        return BLOCKED;
+    }
+    return enter[to]+(climb>0 ? climb*costs.climb : -climb*costs.descend);
+}
+
+int Pathfinder::distance(int from, int to) const {
+    //Offset rows to cube coordinates, where the distance is the largest difference of the three
+    int from_row=terrain->returnRow(from), to_row=terrain->returnRow(to);
+    int from_x=terrain->returnColumn(from)-(from_row-(from_row&1))/2;
+    int to_x=terrain->returnColumn(to)-(to_row-(to_row&1))/2;
+    int dx=to_x-from_x, dz=to_row-from_row;
+    return std::max(abs(dx),std::max(abs(dz),abs(dx+dz)));
+}
+
+Pathfinder::Bounds Pathfinder::clusterBounds(int cluster) const {
+    Bounds bounds;
+    bounds.left=(cluster%cluster_columns)*CLUSTER;
+    bounds.top=(cluster/cluster_columns)*CLUSTER;
+    bounds.right=std::min(bounds.left+(int)CLUSTER,terrain->returnColumns());
+    bounds.bottom=std::min(bounds.top+(int)CLUSTER,terrain->returnRows());
+    return bounds;
+}
+
+Pathfinder::Bounds Pathfinder::mapBounds() const {
+    Bounds bounds={0,0,terrain->returnColumns(),terrain->returnRows()};
+    return bounds;
+}
+
+int Pathfinder::search(Search &s, int from, int to, const Bounds &bounds) const {
+    s.next();
+    uint32_t g=s.generation;
+    s.cost[from]=0;
+    s.parent[from]=-1;
+    s.seen[from]=g;
+    Search::Open first={distance(from,to)*cheapest,from};
+    s.open.push_back(first);
+    while(!s.open.empty()) {
+        int node=s.open.front().node;
+        std::pop_heap(s.open.begin(),s.open.end(),open_after);
+        s.open.pop_back();
+        if(s.seen[node]==g+1) {
+            continue; //a better entry for it came out first
+        }
+        if(node==to) {
+            return s.cost[to];
+        }
+        s.seen[node]=g+1;
+        int column=terrain->returnColumn(node), row=terrain->returnRow(node);
+        for(int direction=0;direction<TerrainGrid::DIRECTIONS;direction++) {
+            int next=terrain->neighbour(column,row,direction);
+            if(next==-1 || s.seen[next]==g+1) {
+                continue;
+            }
+            int c=terrain->returnColumn(next), r=terrain->returnRow(next);
+            if(c<bounds.left || c>=bounds.right || r<bounds.top || r>=bounds.bottom) {
+                continue;
+            }
+            int cost=step(node,next);
+            if(cost==BLOCKED) {
+                continue;
+            }
+            cost+=s.cost[node];
+            if(s.seen[next]!=g || cost<s.cost[next]) {
+                s.cost[next]=cost;
+                s.parent[next]=node;
+                s.seen[next]=g;
+                Search::Open open={cost+distance(next,to)*cheapest,next};
+                s.open.push_back(open);
+                std::push_heap(s.open.begin(),s.open.end(),open_after);
+            }
+        }
+    }
+    return -1;
+}
+
+void Pathfinder::flood(Search &s, int from, const Bounds &bounds, bool reverse) const {
+    s.next();
+    uint32_t g=s.generation;
+    s.cost[from]=0;
+    s.parent[from]=-1;
+    s.seen[from]=g;
+    Search::Open first={0,from};
+    s.open.push_back(first);
+    while(!s.open.empty()) {
+        int node=s.open.front().node;
+        std::pop_heap(s.open.begin(),s.open.end(),open_after);
+        s.open.pop_back();
+        if(s.seen[node]==g+1) {
+            continue;
+        }
+        s.seen[node]=g+1;
+        int column=terrain->returnColumn(node), row=terrain->returnRow(node);
+        for(int direction=0;direction<TerrainGrid::DIRECTIONS;direction++) {
+            int next=terrain->neighbour(column,row,direction);
+            if(next==-1 || s.seen[next]==g+1) {
+                continue;
+            }
+            int c=terrain->returnColumn(next), r=terrain->returnRow(next);
+            if(c<bounds.left || c>=bounds.right || r<bounds.top || r>=bounds.bottom) {
+                continue;
+            }
+            int cost=reverse ? step(next,node) : step(node,next);
+            if(cost==BLOCKED) {
+                continue;
+            }
+            cost+=s.cost[node];
+            if(s.seen[next]!=g || cost<s.cost[next]) {
+                s.cost[next]=cost;
+                s.parent[next]=node;
+                s.seen[next]=g;
+                Search::Open open={cost,next};
+                s.open.push_back(open);
+                std::push_heap(s.open.begin(),s.open.end(),open_after);
+            }
+        }
+    }
+}
+
+bool Pathfinder::trace(const Search &s, int from, int to, std::vector<int> &path) const {
+    int first=path.size();
+    for(int node=to;node!=from;node=s.parent[node]) {
+        if(node==-1) {
+            path.resize(first);
+            return false;
+        }
+        path.push_back(node);
+    }
+    std::reverse(path.begin()+first,path.end());
+    return true;
+}
+
+bool Pathfinder::find(Search &s, int from, int to, std::vector<int> &path, int* cost) const {
+    path.clear();
+    if(terrain==NULL) {
+        return false;
+    }
+    s.prepare(terrain->returnSize(),nodes.size()+2);
+    int total=from==to ? 0 : search(s,from,to,mapBounds());
+    if(total<0) {
+        return false;
+    }
+    path.push_back(from);
+    trace(s,from,to,path);
+    if(cost!=NULL) {
+        *cost=total;
+    }
+    return true;
+}
+
+bool Pathfinder::findHierarchical(Search &s, int from, int to, std::vector<int> &path, int* cost) const {
+    if(!built) {
+        return find(s,from,to,path,cost);
+    }
+    path.clear();
+    int count=nodes.size();
+    s.prepare(terrain->returnSize(),count+2);
+    int start_cluster=clusterOf(from), goal_cluster=clusterOf(to);
+    if(from==to) {
+        return find(s,from,to,path,cost);
+    }
+    if(start_cluster==goal_cluster) {
+        //Most paths inside a cluster stay in it
+        int total=search(s,from,to,clusterBounds(start_cluster));
+        if(total>=0) {
+            path.push_back(from);
+            trace(s,from,to,path);
+            if(cost!=NULL) {
+                *cost=total;
+            }
+            return true;
+        }
+    }
+
+    //Link the start and the goal to the nodes of their clusters
+    s.start_links.clear();
+    flood(s,from,clusterBounds(start_cluster),false);
+    for(int k=cluster_first[start_cluster];k<cluster_first[start_cluster+1];k++) {
+        int node=cluster_nodes[k];
+        if(s.seen[nodes[node]]==s.generation+1) {
+            s.start_links.push_back(std::make_pair(node,s.cost[nodes[node]]));
+        }
+    }
+    s.goal_links.clear();
+    flood(s,to,clusterBounds(goal_cluster),true);
+    for(int k=cluster_first[goal_cluster];k<cluster_first[goal_cluster+1];k++) {
+        int node=cluster_nodes[k];
+        if(s.seen[nodes[node]]==s.generation+1) {
+            s.goal_links.push_back(std::make_pair(node,s.cost[nodes[node]]));
+        }
+    }
+    if(s.start_links.empty() || s.goal_links.empty()) {
+        return false;
+    }
+
+    //A* over the cluster graph, with the start and the goal as two extra nodes
+    const int start=count, goal=count+1;
+    s.next();
+    uint32_t g=s.generation;
+    s.node_cost[start]=0;
+    s.node_parent[start]=-1;
+    s.node_seen[start]=g;
+    Search::Open first={distance(from,to)*cheapest,start};
+    s.open.push_back(first);
+    while(!s.open.empty()) {
+        int node=s.open.front().node;
+        std::pop_heap(s.open.begin(),s.open.end(),open_after);
+        s.open.pop_back();
+        if(s.node_seen[node]==g+1) {
+            continue;
+        }
+        s.node_seen[node]=g+1;
+        if(node==goal) {
+            break;
+        }
+        int links=node==start ? s.start_links.size() : edge_first[node+1]-edge_first[node];
+        bool reaches_goal=node!=start && clusterOf(nodes[node])==goal_cluster;
+        for(int k=0;k<links+(reaches_goal ? (int)s.goal_links.size() : 0);k++) {
+            int next, cost;
+            if(node==start) {
+                next=s.start_links[k].first;
+                cost=s.start_links[k].second;
+            }
+            else if(k<links) {
+                next=edges[edge_first[node]+k].to;
+                cost=edges[edge_first[node]+k].cost;
+            }
+            else if(s.goal_links[k-links].first==node) {
+                next=goal;
+                cost=s.goal_links[k-links].second;
+            }
+            else {
+                continue;
+            }
+            if(s.node_seen[next]==g+1) {
+                continue;
+            }
+            cost+=s.node_cost[node];
+            if(s.node_seen[next]!=g || cost<s.node_cost[next]) {
+                s.node_cost[next]=cost;
+                s.node_parent[next]=node;
+                s.node_seen[next]=g;
+                Search::Open open={cost+(next==goal ? 0 : distance(nodes[next],to)*cheapest),next};
+                s.open.push_back(open);
+                std::push_heap(s.open.begin(),s.open.end(),open_after);
+            }
+        }
+    }
+    if(s.node_seen[goal]!=g+1) {
+        return false;
+    }
+    s.route.clear();
+    for(int node=goal;node!=-1;node=s.node_parent[node]) {
+        s.route.push_back(node);
+    }
+    std::reverse(s.route.begin(),s.route.end());
+
+    //Tile paths between the nodes of the route, each inside one cluster or a single step between two
+    int current=from, total=0;
+    path.push_back(from);
+    for(int k=1;k<(int)s.route.size();k++) {
+        int target=s.route[k]==goal ? to : nodes[s.route[k]];
+        if(target==current) {
+            continue;
+        }
+        int cluster=clusterOf(current);
+        if(cluster!=clusterOf(target)) {
+            total+=step(current,target);
+            path.push_back(target);
+        }
+        else {
+            int cost=search(s,current,target,clusterBounds(cluster));
+            if(cost<0 || !trace(s,current,target,path)) {
+                path.clear();
+                return false;
+            }
+            total+=cost;
+        }
+        current=target;
+    }
+    if(cost!=NULL) {
+        *cost=total;
+    }
+    return true;
+}
+
+void Pathfinder::findBatch(std::vector<Query> &queries, ThreadPool &pool) {
+    int threads=std::max(pool.returnThreads(),1);
+    if((int)searches.size()<threads) {
+        searches.resize(threads);
+    }
+    for(int j=0;j<threads;j++) {
+        pool.push([this,j,threads,&queries]() {
+            for(int q=j;q<(int)queries.size();q+=threads) {
+                Query &query=queries[q];
+                bool found=query.hierarchical ? findHierarchical(searches[j],query.from,query.to,query.path,&query.cost) : find(searches[j],query.from,query.to,query.path,&query.cost);
+                if(!found) {
+                    query.cost=-1;
+                }
+            }
+        });
+    }
+    pool.wait();
+}
+
+int Pathfinder::addNode(int tile) {
+    if(node_of[tile]==-1) {
+        node_of[tile]=nodes.size();
+        nodes.push_back(tile);
+    }
+    return node_of[tile];
+}
+
+void Pathfinder::placeCrossings(int cluster, std::vector<Transition> &transitions, std::vector<Crossing> &placed) const {
+    //Every step from a tile on the edge of the cluster into a higher numbered one
+    Bounds bounds=clusterBounds(cluster);
+    transitions.clear();
+    for(int row=bounds.top;row<bounds.bottom;row++) {
+        for(int column=bounds.left;column<bounds.right;column++) {
+            if(column%CLUSTER!=0 && column%CLUSTER!=CLUSTER-1 && row%CLUSTER!=0 && row%CLUSTER!=CLUSTER-1) {
+                continue;
+            }
+            int a=terrain->index(column,row);
+            for(int direction=0;direction<TerrainGrid::DIRECTIONS;direction++) {
+                int b=terrain->neighbour(column,row,direction);
+                if(b==-1 || clusterOf(b)<=cluster || (step(a,b)==BLOCKED && step(b,a)==BLOCKED)) {
+                    continue;
+                }
+                Transition transition={a,b,cluster,clusterOf(b)};
+                transitions.push_back(transition);
+            }
+        }
+    }
+    std::sort(transitions.begin(),transitions.end(),[](const Transition &x, const Transition &y) {
+        if(x.to_cluster!=y.to_cluster) return x.to_cluster<y.to_cluster;
+        if(x.a!=y.a) return x.a<y.a;
+        return x.b<y.b;
+    });
+
+    //A pair of nodes in the middle of every unbroken run of transitions between two clusters, or at both ends of a
+    //long run so paths along the border don't have to detour through its middle
+    placed.clear();
+    for(int first=0;first<(int)transitions.size();) {
+        int last=first+1;
+        while(last<(int)transitions.size() && transitions[last].to_cluster==transitions[first].to_cluster
+              && (distance(transitions[last-1].a,transitions[last].a)<=1 || distance(transitions[last-1].b,transitions[last].b)<=1)) {
+            last++;
+        }
+        int picks[3]={(first+last)/2,first,last-1};
+        for(int k=last-first>LONG_RUN ? 1 : 0;k<(last-first>LONG_RUN ? 3 : 1);k++) {
+            Crossing crossing={transitions[picks[k]].a,transitions[picks[k]].b};
+            placed.push_back(crossing);
+        }
+        first=last;
+    }
+}
+
+void Pathfinder::linkCluster(Search &s, int cluster, std::vector<Link> &links) const {
+    Bounds bounds=clusterBounds(cluster);
+    links.clear();
+    for(int k=cluster_first[cluster];k<cluster_first[cluster+1];k++) {
+        int node=cluster_nodes[k];
+        flood(s,nodes[node],bounds,false);
+        for(int m=cluster_first[cluster];m<cluster_first[cluster+1];m++) {
+            int other=cluster_nodes[m];
+            if(other!=node && s.seen[nodes[other]]==s.generation+1) {
+                Link link={nodes[node],nodes[other],s.cost[nodes[other]]};
+                links.push_back(link);
+            }
+        }
+    }
+}
+
+void Pathfinder::collectNodes() {
+    //Numbered afresh from every cluster's crossings, in the order build() always placed them
+    for(int node=0;node<(int)nodes.size();node++) {
+        node_of[nodes[node]]=-1;
+    }
+    nodes.clear();
+    int clusters=cluster_columns*cluster_rows;
+    for(int c=0;c<clusters;c++) {
+        for(int k=0;k<(int)crossings[c].size();k++) {
+            addNode(crossings[c][k].a);
+            addNode(crossings[c][k].b);
+        }
+    }
+
+    //Nodes grouped by cluster
+    cluster_first.assign(clusters+1,0);
+    for(int node=0;node<(int)nodes.size();node++) {
+        cluster_first[clusterOf(nodes[node])+1]++;
+    }
+    for(int c=0;c<clusters;c++) {
+        cluster_first[c+1]+=cluster_first[c];
+    }
+    cluster_nodes.resize(nodes.size());
+    std::vector<int> filled(cluster_first.begin(),cluster_first.end()-1);
+    for(int node=0;node<(int)nodes.size();node++) {
+        cluster_nodes[filled[clusterOf(nodes[node])]++]=node;
+    }
+}
+
+void Pathfinder::collectEdges() {
+    //The step across every crossing and the costs across every cluster, by tile, turned into edges between nodes
+    std::vector<std::vector<Edge> > links(nodes.size());
+    int clusters=cluster_columns*cluster_rows;
+    for(int c=0;c<clusters;c++) {
+        for(int k=0;k<(int)crossings[c].size();k++) {
+            const Crossing &crossing=crossings[c][k];
+            int a=node_of[crossing.a], b=node_of[crossing.b];
+            Edge ab={b,step(crossing.a,crossing.b)}, ba={a,step(crossing.b,crossing.a)};
+            if(ab.cost!=BLOCKED) {
+                links[a].push_back(ab);
+            }
+            if(ba.cost!=BLOCKED) {
+                links[b].push_back(ba);
+            }
+        }
+    }
+    for(int c=0;c<clusters;c++) {
+        for(int k=0;k<(int)inside[c].size();k++) {
+            Edge edge={node_of[inside[c][k].to],inside[c][k].cost};
+            links[node_of[inside[c][k].from]].push_back(edge);
+        }
+    }
+
+    edge_first.assign(nodes.size()+1,0);
+    edges.clear();
+    for(int node=0;node<(int)nodes.size();node++) {
+        edges.insert(edges.end(),links[node].begin(),links[node].end());
+        edge_first[node+1]=edges.size();
+    }
+}
+
+bool Pathfinder::build(ThreadPool &pool) {
+    if(terrain==NULL) {
+        return false;
+    }
+    built=false;
+    int columns=terrain->returnColumns(), rows=terrain->returnRows();
+    cluster_columns=(columns+CLUSTER-1)/CLUSTER;
+    cluster_rows=(rows+CLUSTER-1)/CLUSTER;
+    int clusters=cluster_columns*cluster_rows;
+
+    crossings.assign(clusters,std::vector<Crossing>());
+    inside.assign(clusters,std::vector<Link>());
+    std::vector<Transition> transitions;
+    for(int c=0;c<clusters;c++) {
+        placeCrossings(c,transitions,crossings[c]);
+    }
+    nodes.clear();
+    node_of.assign(terrain->returnSize(),-1);
+    collectNodes();
+
+    //Costs across every cluster between its nodes, each thread taking every threads-th cluster
+    int threads=std::max(pool.returnThreads(),1);
+    if((int)searches.size()<threads) {
+        searches.resize(threads);
+    }
+    for(int j=0;j<threads;j++) {
+        pool.push([this,j,threads,clusters]() {
+            Search &s=searches[j];
+            s.prepare(terrain->returnSize(),0);
+            for(int c=j;c<clusters;c+=threads) {
+                linkCluster(s,c,inside[c]);
+            }
+        });
+    }
+    pool.wait();
+
+    collectEdges();
+    built=true;
+    return true;
+}
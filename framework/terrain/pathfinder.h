@@ -0,0 +1,116 @@
+#ifndef PATHFINDER_H
+#define PATHFINDER_H
+
+//Shortest paths over the hex grid. Entering a tile costs 100*100/mobility, so a tile of mobility 100 costs 100 and
+//one of mobility 0 can't be entered, plus a penalty for every level climbed or descended. Steps of more than
+//max_step levels are cliffs and can't be taken.
+//
+//A Search holds every buffer one query needs, sized to the map once, so a query allocates nothing but the path it
+//returns. Searches are independent, so any number of threads can query at once, each with its own Search.
+//
+//Long routes use a graph over clusters of CLUSTER*CLUSTER tiles: a node on each side of every passable gap between
+//two clusters, with the cost of crossing each cluster between its nodes worked out in advance. A query searches
+//that graph and then only finds the tile path inside the clusters it crosses. On a large map that is about a tenth
+//of the search for paths about a tenth longer than the shortest.
+
+class Pathfinder {
+public:
+    enum {CLUSTER=16, LONG_RUN=8, BLOCKED=0xFFFF}; //CLUSTER*CLUSTER tiles per cluster, gaps of more than LONG_RUN transitions get a node at each end, BLOCKED is the cost of a tile that can't be entered
+
+    struct Costs {
+        int climb; //per level up
+        int descend; //per level down
+        int max_step; //levels a single step can change by
+    };
+
+    struct Query {
+        int from, to; //tile indices
+        bool hierarchical; //use the cluster graph
+        std::vector<int> path; //tiles from from to to, both included, empty if there is no path
+        int cost;
+    };
+
+    //The buffers of one query, reused by every query run with it
+    class Search {
+    public:
+        struct Open {int f, node;}; //a tile or node on the frontier and its estimated total cost
+
+        Search() {generation=0;}
+    private:
+        friend class Pathfinder;
+        void prepare(int tiles, int nodes); //Grows the buffers to a map, once
+        void next(); //Starts a new query, forgetting the last one without clearing anything
+
+        std::vector<int> cost; //per tile, cost from the start
+        std::vector<int> parent; //per tile, previous tile on the best path
+        std::vector<uint32_t> seen; //per tile, generation it was reached in, generation+1 once it is final
+        std::vector<int> node_cost, node_parent; //the same per cluster graph node, with start and goal at the end
+        std::vector<uint32_t> node_seen;
+        std::vector<Open> open; //binary heap of the frontier
+        std::vector<std::pair<int,int> > start_links, goal_links; //cluster graph nodes reachable from the start and reaching the goal, with their costs
+        std::vector<int> route; //cluster graph nodes of the path
+        uint32_t generation;
+    };
+
+    //Constructors & Deconstructors
+    Pathfinder(); //Default Constructor
+
+    //Map
+    void attach(const TerrainGrid &terrain_, Costs costs_); //Works out the cost of entering every tile, the cluster graph is built by build()
+    void update(int i); //The tile at index i changed, its cost is worked out again and the cluster graph repaired around it
+    void update(const std::vector<int> &changed); //The same for many tiles, the graph repaired once
+    bool build(ThreadPool &pool); //Builds the cluster graph on the pool, not from a job on it
+
+    //Queries
+    bool find(Search &search, int from, int to, std::vector<int> &path, int* cost=NULL) const; //Shortest path
+    bool findHierarchical(Search &search, int from, int to, std::vector<int> &path, int* cost=NULL) const; //Path through the cluster graph, find() if it isn't built
+    void findBatch(std::vector<Query> &queries, ThreadPool &pool); //Runs queries split across the pool's threads, not from a job on it
+
+    //Accessors
+    int step(int from, int to) const; //Cost of stepping between neighbours, BLOCKED if it can't be taken
+    int distance(int from, int to) const; //Hex distance in steps
+    bool returnBuilt() const {return built;}
+    int returnNodes() const {return nodes.size();}
+    int returnEdges() const {return edges.size();}
+    Costs returnCosts() const {return costs;}
+
+private:
+    struct Bounds {int left, top, right, bottom;}; //tiles a search stays inside, right and bottom excluded
+    struct Edge {int to, cost;};
+    struct Transition {int a, b, from_cluster, to_cluster;};
+    struct Crossing {int a, b;}; //tiles of a pair of nodes either side of a gap, a in the lower numbered cluster
+    struct Link {int from, to, cost;}; //cost across a cluster between the tiles of two of its nodes
+
+    int clusterOf(int i) const {return (terrain->returnRow(i)/CLUSTER)*cluster_columns+terrain->returnColumn(i)/CLUSTER;}
+    Bounds clusterBounds(int cluster) const;
+    Bounds mapBounds() const;
+    int search(Search &s, int from, int to, const Bounds &bounds) const; //A* inside bounds, returns the cost or -1
+    void flood(Search &s, int from, const Bounds &bounds, bool reverse) const; //Dijkstra from (or, reversed, to) a tile over all of bounds
+    bool trace(const Search &s, int from, int to, std::vector<int> &path) const; //Appends the tiles after from up to to
+    void price(int i); //Cost of entering tile i
+    int addNode(int tile); //Node of a tile in the cluster graph, added if it has none
+    void placeCrossings(int cluster, std::vector<Transition> &transitions, std::vector<Crossing> &placed) const; //Node pairs on the gaps into higher numbered clusters, transitions is scratch
+    void linkCluster(Search &s, int cluster, std::vector<Link> &links) const; //Costs between the nodes of a cluster
+    void collectNodes(); //Numbers the nodes of every cluster's crossings and groups them by cluster
+    void collectEdges(); //Edges of every node from the crossings and the links
+
+    const TerrainGrid* terrain;
+    Costs costs;
+    std::vector<uint16_t> enter; //cost of entering every tile, BLOCKED if it can't be
+    int cheapest; //lowest enter cost on the map, for the A* estimate
+    std::vector<Search> searches; //one per thread of the pool, for batches and building
+
+    //Cluster graph
+    bool built;
+    int cluster_columns, cluster_rows;
+    std::vector<int> nodes; //tile of every node
+    std::vector<int> node_of; //node of every tile, -1 if none
+    std::vector<int> cluster_first; //nodes of cluster c are cluster_nodes[cluster_first[c]] to cluster_nodes[cluster_first[c+1]-1]
+    std::vector<int> cluster_nodes;
+    std::vector<int> edge_first; //edges of node n are edges[edge_first[n]] to edges[edge_first[n+1]-1]
+    std::vector<Edge> edges;
+    std::vector<std::vector<Crossing> > crossings; //per cluster, kept by tile so an update only redoes the clusters around it
+    std::vector<std::vector<Link> > inside; //per cluster, by tile for the same reason
+};
+
+#endif // PATHFINDER_H
@@ -0,0 +1,87 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <stdint.h>
+#include <stdlib.h>
+#include <algorithm>
+#include "terraingrid.h"
+#include "picking.h"
+
+//Rounds down for negative values too
+static int floor_divide(int a, int b) {
+    return a>=0 ? a/b : -((-a+b-1)/b);
+}
+
+HexPicker::HexPicker(int width, int row_height, int tile_height, int lift) : width(width), row_height(row_height), tile_height(tile_height), lift(lift) {
+    //The top of a hex is a triangle tile_height-row_height pixels high which reaches into the row above. A pixel in
+    //the triangle band of a row belongs to that row if it is below the slanted edges, otherwise to the row above.
+    int block_height=2*row_height;
+    int slope=tile_height-row_height;
+    int half=width/2;
+    columns.resize(width*block_height);
+    rows.resize(width*block_height);
+    for(int y=0;y<block_height;y++) {
+        for(int x=0;x<width;x++) {
+            int row=y/row_height;
+            int band=y%row_height;
+            int local=(x-(row&1)*half+width)%width;
+            if(band*half<slope*abs(local-half)) {
+                row--;
+            }
+            //Rows of the other parity are shifted half a tile, so their column can be one less
+            int column=floor_divide(x-(row&1)*half,width);
+            columns[y*width+x]=column;
+            rows[y*width+x]=row;
+        }
+    }
+}
+
+void HexPicker::cell(int x, int y, int &column, int &row) const {
+    int block_height=2*row_height;
+    int bx=floor_divide(x,width), by=floor_divide(y,block_height);
+    int i=(y-by*block_height)*width+(x-bx*width);
+    column=bx+columns[i];
+    row=2*by+rows[i];
+}
+
+bool HexPicker::pick(const TerrainGrid &terrain, int x, int y, int &column, int &row) const {
+    //Every level is a flat lookup shifted down by its lift. The tile found at a level only counts if it really is
+    //at that level, and of those the one furthest down the screen is in front.
+    bool found=false;
+    for(int level=0;level<LEVELS;level++) {
+        int c, r;
+        cell(x,y+level*lift,c,r);
+        if(terrain.contains(c,r) && terrain.returnLevel(c,r)==level && (!found || r>row)) {
+            column=c;
+            row=r;
+            found=true;
+        }
+    }
+    //Below a raised tile, where no tile is drawn at its own level, the flat tile is the one meant
+    if(!found) {
+        cell(x,y,column,row);
+        found=terrain.contains(column,row);
+    }
+    return found;
+}
+
+int HexPicker::pickRect(const TerrainGrid &terrain, SDL_Rect area, std::vector<int> &indices) const {
+    indices.clear();
+    //Rows whose centre can be in area at any level, then only the columns that cross it
+    int first_row=std::max(floor_divide(area.y-tile_height/2,row_height),0);
+    int last_row=std::min(floor_divide(area.y+area.h-tile_height/2+(LEVELS-1)*lift,row_height),terrain.returnRows()-1);
+    int first_column=std::max(floor_divide(area.x-width,width),0);
+    int last_column=std::min(floor_divide(area.x+area.w,width),terrain.returnColumns()-1);
+    for(int row=first_row;row<=last_row;row++) {
+        const int8_t* levels=terrain.returnLevelRow(row);
+        for(int column=first_column;column<=last_column;column++) {
+            int x=returnX(column,row)+width/2;
+            int y=returnY(row,levels[column])+tile_height/2;
+            if(x>=area.x && x<area.x+area.w && y>=area.y && y<area.y+area.h) {
+                indices.push_back(terrain.index(column,row));
+            }
+        }
+    }
+    return indices.size();
+}
@@ -0,0 +1,33 @@
+#ifndef PICKING_H
+#define PICKING_H
+
+//Maps pixels of the map to hex tiles. Two rows of hexes repeat every tile width across and every two rows down, so
+//which tile owns a pixel is precomputed once for that block and looked up for any pixel on any size of map.
+//A tile of level L is drawn raised by L*lift pixels, so picking looks for the front-most raised tile first.
+
+class HexPicker {
+public:
+    enum {LEVELS=8}; //levels picking looks at, from 0 to LEVELS-1
+
+    //Constructors & Deconstructors
+    HexPicker(int width=50, int row_height=28, int tile_height=40, int lift=10); //Builds the lookup for a tile shape
+
+    //Picking
+    void cell(int x, int y, int &column, int &row) const; //Tile whose flat hex contains x,y, can be off the map
+    bool pick(const TerrainGrid &terrain, int x, int y, int &column, int &row) const; //Tile drawn at x,y, false off the map
+    int pickRect(const TerrainGrid &terrain, SDL_Rect area, std::vector<int> &indices) const; //Tiles whose drawn centre is in area, returns the count
+
+    //Accessors
+    int returnX(int column, int row) const {return column*width+(row&1)*(width/2);} //Left of a tile
+    int returnY(int row, int level=0) const {return row*row_height-level*lift;} //Top of a tile raised by level
+    int returnWidth() const {return width;}
+    int returnRowHeight() const {return row_height;}
+    int returnLift() const {return lift;}
+
+private:
+    int width, row_height, tile_height, lift;
+    std::vector<int8_t> columns; //column offset from the block, one per pixel of a width*(2*row_height) block
+    std::vector<int8_t> rows; //row offset from the block
+};
+
+#endif // PICKING_H
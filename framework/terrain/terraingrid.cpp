@@ -0,0 +1,96 @@
+#include <stdint.h>
+#include <vector>
+#include "terraingrid.h"
+
+//Column offsets of the neighbours in each direction, for even and odd rows
+static const int neighbour_columns[2][TerrainGrid::DIRECTIONS] = {
+    {1, 0, -1, -1, -1, 0},
+    {1, 1, 0, -1, 0, 1}
+};
+static const int neighbour_rows[TerrainGrid::DIRECTIONS] = {0, 1, 1, 0, -1, -1};
+
+TerrainGrid::TerrainGrid(int columns_, int rows_) {
+    columns=0;
+    rows=0;
+    resize(columns_,rows_);
+}
+
+void TerrainGrid::resize(int columns_, int rows_) {
+    columns=columns_;
+    rows=rows_;
+    types.assign(columns*rows,0);
+    variants.assign(columns*rows,0);
+    levels.assign(columns*rows,0);
+    mobilities.assign(columns*rows,0);
+}
+
+void TerrainGrid::setTile(int column, int row, uint8_t type, uint8_t variant, int level, int mobility) {
+    int i=index(column,row);
+    types[i]=type;
+    variants[i]=variant;
+    levels[i]=level;
+    mobilities[i]=mobility;
+}
+
+int TerrainGrid::assign(int columns_, int rows_, const uint8_t* types_, const uint8_t* variants_, const int8_t* levels_, const int16_t table[256], const uint8_t mobility[256]) {
+    //Variants and levels are copied straight in, nothing is cleared first
+    int size=columns_*rows_;
+    columns=columns_;
+    rows=rows_;
+    variants.assign(variants_,variants_+size);
+    levels.assign(levels_,levels_+size);
+    types.resize(size);
+    mobilities.resize(size);
+    //Types are checked, converted and given their mobility in one pass
+    for(int i=0;i<size;i++) {
+        int type=table[types_[i]];
+        if(type<0) {
+            return i;
+        }
+        types[i]=type;
+        mobilities[i]=mobility[type];
+    }
+    return -1;
+}
+
+int TerrainGrid::neighbour(int column, int row, int direction) const {
+    int c=column+neighbour_columns[row&1][direction];
+    int r=row+neighbour_rows[direction];
+    if(!contains(c,r)) {
+        return -1;
+    }
+    return index(c,r);
+}
+
+int TerrainGrid::neighbours(int column, int row, int out[DIRECTIONS]) const {
+    int count=0;
+    for(int direction=0;direction<DIRECTIONS;direction++) {
+        int i=neighbour(column,row,direction);
+        if(i!=-1) {
+            out[count++]=i;
+        }
+    }
+    return count;
+}
+
+//A hash of the seed, position and type, so any tile's variant can be worked out on its own, in any order, on any
+//thread, and comes out the same every time the map is loaded
+
+uint8_t TerrainGrid::variantFor(uint32_t seed, int column, int row, int type) {
+    uint32_t h=seed^((uint32_t)column*0x9E3779B1u)^((uint32_t)row*0x85EBCA77u)^((uint32_t)type*0xC2B2AE3Du);
+    h^=h>>16;
+    h*=0x7FEB352Du;
+    h^=h>>15;
+    h*=0x846CA68Bu;
+    h^=h>>16;
+    return h>>24;
+}
+
+void TerrainGrid::assignVariants(uint32_t seed) {
+    for(int row=0;row<rows;row++) {
+        for(int column=0;column<columns;column++) {
+            int i=index(column,row);
+            variants[i]=variantFor(seed,column,row,types[i]);
+        }
+    }
+}
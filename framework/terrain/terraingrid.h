@@ -0,0 +1,63 @@
+#ifndef TERRAINGRID_H
+#define TERRAINGRID_H
+
+//The map as parallel arrays, one entry per tile in row order. Every tile costs four bytes, so a scan over a large
+//map for rendering, picking or simulation touches as little memory as possible. Rows are offset hexes: odd rows
+//sit half a tile to the right of even rows.
+
+class TerrainGrid {
+public:
+    enum Direction {EAST, SOUTH_EAST, SOUTH_WEST, WEST, NORTH_WEST, NORTH_EAST, DIRECTIONS};
+
+    //Constructors & Deconstructors
+    TerrainGrid() {columns=0;rows=0;} //Default Constructor
+    TerrainGrid(int columns_, int rows_); //Creates an empty map of the given size
+
+    //Accessors
+    int returnColumns() const {return columns;}
+    int returnRows() const {return rows;}
+    int returnSize() const {return columns*rows;}
+    int index(int column, int row) const {return row*columns+column;}
+    int returnColumn(int i) const {return i%columns;}
+    int returnRow(int i) const {return i/columns;}
+    bool contains(int column, int row) const {return column>=0 && row>=0 && column<columns && row<rows;}
+
+    uint8_t returnType(int i) const {return types[i];}
+    uint8_t returnVariant(int i) const {return variants[i];}
+    int returnLevel(int i) const {return levels[i];}
+    int returnMobility(int i) const {return mobilities[i];}
+    uint8_t returnType(int column, int row) const {return types[index(column,row)];}
+    uint8_t returnVariant(int column, int row) const {return variants[index(column,row)];}
+    int returnLevel(int column, int row) const {return levels[index(column,row)];}
+    int returnMobility(int column, int row) const {return mobilities[index(column,row)];}
+
+    //Whole rows, for scans that walk a row at a time
+    const uint8_t* returnTypeRow(int row) const {return &types[row*columns];}
+    const uint8_t* returnVariantRow(int row) const {return &variants[row*columns];}
+    const int8_t* returnLevelRow(int row) const {return &levels[row*columns];}
+    const uint8_t* returnMobilityRow(int row) const {return &mobilities[row*columns];}
+
+    //Neighbours
+    int neighbour(int column, int row, int direction) const; //Index of the neighbour in a direction, -1 off the map
+    int neighbours(int column, int row, int out[DIRECTIONS]) const; //Fills out with the indices of all neighbours on the map, returns the count
+
+    //Modifiers
+    void resize(int columns_, int rows_); //Resizes and clears the map
+    void setTile(int column, int row, uint8_t type, uint8_t variant, int level, int mobility);
+    void setVariant(int column, int row, uint8_t variant) {variants[index(column,row)]=variant;}
+    int assign(int columns_, int rows_, const uint8_t* types_, const uint8_t* variants_, const int8_t* levels_, const int16_t table[256], const uint8_t mobility[256]); //Copies whole arrays in, type ids through table and mobilities by the new id, returns the first tile whose id table has as -1, or -1
+
+    //Variants
+    static uint8_t variantFor(uint32_t seed, int column, int row, int type); //Variant a tile gets on a map with a seed, drawn modulo the texture count
+    void assignVariants(uint32_t seed); //Sets the variant of every tile from the seed
+
+private:
+    int columns, rows;
+
+    std::vector<uint8_t> types; //tile type id
+    std::vector<uint8_t> variants; //which texture of the type is drawn
+    std::vector<int8_t> levels; //elevation
+    std::vector<uint8_t> mobilities; //How quickly units can move through the tile
+};
+
+#endif // TERRAINGRID_H
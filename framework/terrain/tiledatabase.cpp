@@ -0,0 +1,103 @@
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <stdlib.h>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <stdint.h>
+#include "../interface/tile.h"
+#include "tiledatabase.h"
+
+bool TileDatabase::parse(std::string path, std::map<std::string,Tile> &alltiles) {
+    std::ifstream f_tiles(path.c_str());
+    if (!f_tiles.good()) {
+        printf("Can't open tiles.txt.\n");
+        return false;
+    }
+    //<name starts a tile, >key value sets one of its values, anything else is skipped
+    std::string buffer, value;
+    std::map<std::string,Tile>::iterator tile=alltiles.end();
+    while(f_tiles>>buffer) {
+        if(buffer[0]=='<') {
+            std::string name=buffer.substr(1);
+            if(name.empty()) {
+                printf("A tile in %s has no name.\n",path.c_str());
+                return false;
+            }
+            tile=alltiles.insert(std::pair<std::string,Tile>(name,Tile(name))).first;
+        }
+        else if(buffer[0]=='>') {
+            std::string key=buffer.substr(1);
+            if(key!="capacity" && key!="mobility" && key!="level" && key!="below" && key!="animate") {
+                continue;
+            }
+            if(tile==alltiles.end()) {
+                printf("%s in %s comes before the first tile name.\n",buffer.c_str(),path.c_str());
+                return false;
+            }
+            if(!(f_tiles>>value)) {
+                printf("%s of %s in %s has no value.\n",key.c_str(),tile->first.c_str(),path.c_str());
+                return false;
+            }
+            if(key=="capacity") {
+                tile->second.setCapacity(std::atoi(value.c_str()));
+            }
+            else if(key=="mobility") {
+                tile->second.setMobility(std::atoi(value.c_str()));
+            }
+            else if(key=="level") {
+                tile->second.setLevel(std::atoi(value.c_str()));
+            }
+            else if(key=="below") {
+                tile->second.setBelow(value);
+            }
+            else {
+                tile->second.setFrameTime(std::max(std::atoi(value.c_str()),0));
+            }
+        }
+    }
+    return true;
+}
+
+bool TileDatabase::compile(std::map<std::string,Tile> &alltiles) {
+    if(alltiles.size()>256) {
+        printf("Too many tile types, at most 256 are supported.\n");
+        return false;
+    }
+    names.clear(); capacities.clear(); mobilities.clear(); levels.clear(); below.clear(); frame_times.clear(); textures.clear();
+    for(std::map<std::string,Tile>::iterator it=alltiles.begin();it!=alltiles.end();++it) {
+        names.push_back(it->first);
+        capacities.push_back(it->second.returnCapacity());
+        mobilities.push_back(it->second.returnMobility());
+        levels.push_back(it->second.returnLevel());
+        frame_times.push_back(it->second.returnFrameTime());
+        textures.push_back(-1);
+    }
+    for(std::map<std::string,Tile>::iterator it=alltiles.begin();it!=alltiles.end();++it) {
+        below.push_back(find(it->second.returnBelow()));
+    }
+    //Walk the below chain of every type once per level. A chain that ends above the level stays on its last type.
+    lower.assign(names.size()*LEVELS,0);
+    for(int id=0;id<(int)names.size();id++) {
+        for(int level=0;level<LEVELS;level++) {
+            int type=id;
+            int steps=0;
+            while(levels[type]>level && below[type]!=-1 && steps<(int)names.size()) {
+                type=below[type];
+                steps++;
+            }
+            lower[id*LEVELS+level]=type;
+        }
+    }
+    return true;
+}
+
+int TileDatabase::find(const std::string &name) const {
+    for(int id=0;id<(int)names.size();id++) {
+        if(names[id]==name) {
+            return id;
+        }
+    }
+    return -1;
+}
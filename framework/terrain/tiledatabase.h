@@ -0,0 +1,48 @@
+#ifndef TILEDATABASE_H
+#define TILEDATABASE_H
+
+//The tile definitions from tilesnew.txt compiled into arrays indexed by tile type id. The "below" chain is resolved
+//once for every type and level, so finding what a tile looks like at a lower level is a single lookup.
+
+class TileDatabase {
+public:
+    enum {LEVELS=8}; //levels 0 to LEVELS-1 are precomputed
+
+    //Constructors & Deconstructors
+    TileDatabase() {;} //Default Constructor
+
+    //Reads tile definitions (assets/tilesnew.txt) into alltiles
+    static bool parse(std::string path, std::map<std::string,Tile> &alltiles);
+
+    //Compiles the definitions, ids follow the order of the map so they are the same every run
+    bool compile(std::map<std::string,Tile> &alltiles);
+
+    //Accessors
+    int returnCount() const {return names.size();}
+    int find(const std::string &name) const; //Returns the id of a tile type, -1 if there is none
+    const std::string &returnName(int id) const {return names[id];}
+    int returnCapacity(int id) const {return capacities[id];}
+    int returnMobility(int id) const {return mobilities[id];}
+    int returnLevel(int id) const {return levels[id];}
+    int returnBelow(int id) const {return below[id];} //-1 if nothing is below
+    int returnTextures(int id) const {return textures[id];} //Texture group handle, -1 if none is set
+    int returnFrameTime(int id) const {return frame_times[id];} //Milliseconds a texture variant is shown for, 0 if the tile is still
+    int returnLower(int id, int level) const {return lower[id*LEVELS+clampLevel(level)];} //Type drawn for id when looking at level
+
+    //Modifiers
+    void setTextures(int id, int group) {textures[id]=group;}
+
+private:
+    static int clampLevel(int level) {return level<0 ? 0 : (level>=LEVELS ? LEVELS-1 : level);}
+
+    std::vector<std::string> names;
+    std::vector<int> capacities;
+    std::vector<int> mobilities;
+    std::vector<int> levels;
+    std::vector<int> below;
+    std::vector<int> frame_times;
+    std::vector<int> textures;
+    std::vector<uint8_t> lower; //LEVELS entries per type
+};
+
+#endif // TILEDATABASE_H
@@ -0,0 +1,370 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <cmath>
+#include <stdint.h>
+#include <memory>
+#include <functional>
+#include <deque>
+
+#include <boost/filesystem.hpp>
+
+#include "../render/texturecache.h"
+#include "../render/atlas.h"
+#include "../render/spritebatch.h"
+#include "../interface/texture.h"
+#include "../core/threadpool.h"
+#include "../interface/tile.h"
+#include "chunkcache.h"
+#include "terraingrid.h"
+#include "tiledatabase.h"
+#include "mapfile.h"
+#include "picking.h"
+#include "minimap.h"
+#include "worldgen.h"
+#include "world.h"
+
+//---------Texture_Functions------------------------
+
+//Reserves an atlas slot for every .png under location, grouped by the directory it is in relative to assets/textures
+
+void scan_textures(std::string location, std::string group, Atlas &atlas, std::vector<Texture_File> &files) {
+    boost::filesystem::path path(location);
+    boost::filesystem::directory_iterator b(path), e;
+    std::vector<boost::filesystem::path> directory(b, e);
+    std::sort(directory.begin(),directory.end());
+    for(int i=0;i<(int)directory.size();i++) {
+        if(boost::filesystem::is_directory(directory[i])) {
+            scan_textures(directory[i].string(),(group.empty() ? "" : group+"/")+directory[i].filename().string(),atlas,files);
+        }
+        else if(directory[i].extension().string()==".png" && !group.empty()) {
+            Texture_File file;
+            file.variant=atlas.add(group,directory[i].stem().string());
+            file.group=atlas.findGroup(group);
+            file.path=directory[i].string();
+            files.push_back(file);
+        }
+    }
+}
+
+//---------Map_Functions------------------------
+
+bool initTiles(std::map<std::string,Tile> &alltiles) {
+    return TileDatabase::parse("../Settlements/assets/tilesnew.txt",alltiles);
+}
+
+//Compiles the tile definitions and gives every tile type the atlas group of its textures. Fails if any type has no
+//textures, drawing looks every type's group up without checking.
+
+bool compile_tile_types(std::map<std::string,Tile> &alltiles, Terrain_Resources &Terrain_Resource, Atlas &atlas) {
+    if(!Terrain_Resource.types.compile(alltiles)) {
+        return false;
+    }
+    for(int id=0;id<Terrain_Resource.types.returnCount();id++) {
+        int group=atlas.findGroup(Terrain_Resource.types.returnName(id));
+        if(group==-1 || atlas.returnVariants(group)==0) {
+            printf("No textures for tile %s.\n",Terrain_Resource.types.returnName(id).c_str());
+            return false;
+        }
+        Terrain_Resource.types.setTextures(id,group);
+    }
+    return true;
+}
+
+//Finds the tallest terrain texture and the minimap colour of every type once the images are decoded
+
+void measure_tile_types(Terrain_Resources &Terrain_Resource, Atlas &atlas) {
+    Terrain_Resource.tallest=0;
+    Terrain_Resource.colours.clear();
+    for(int id=0;id<Terrain_Resource.types.returnCount();id++) {
+        int group=Terrain_Resource.types.returnTextures(id);
+        Terrain_Resource.colours.push_back(atlas.returnColour(group));
+        for(int i=0;i<atlas.returnVariants(group);i++) {
+            Terrain_Resource.tallest=std::max(Terrain_Resource.tallest,atlas.returnSprite(group,i).rect.h);
+        }
+    }
+}
+
+//Sizes the world in pixels after a new map is loaded
+
+static void measure_world(Terrain_Resources &Terrain_Resource) {
+    int w=Terrain_Resource.terrain.returnColumns();
+    int h=Terrain_Resource.terrain.returnRows();
+    Terrain_Resource.columns=w;
+    Terrain_Resource.rows=h;
+    Terrain_Resource.world_width=w*Terrain_Resource.width+Terrain_Resource.width/2;
+    Terrain_Resource.world_height=h*28+12;
+}
+
+//Loads a text or binary map, whichever location holds. Text maps get their variants from Terrain_Resource.seed,
+//binary maps bring the seed their variants were picked with.
+
+bool map_parse(Terrain_Resources &Terrain_Resource, std::string location) {
+    bool loaded;
+    if(MapFile::isBinary(location)) {
+        MapFile file;
+        loaded=file.open(location) && file.load(Terrain_Resource.types,Terrain_Resource.terrain);
+        if(loaded) {
+            Terrain_Resource.seed=file.returnHeader()->seed;
+        }
+    }
+    else {
+        loaded=MapFile::parseText(location,Terrain_Resource.types,Terrain_Resource.seed,Terrain_Resource.terrain);
+    }
+    if(!loaded) {
+        return false;
+    }
+    measure_world(Terrain_Resource);
+    return true;
+}
+
+//Replaces the map with a generated one. Runs its jobs on pool, so it can't be called from one of them.
+
+bool generate_world(Terrain_Resources &Terrain_Resource, int columns, int rows, uint32_t seed, ThreadPool &pool) {
+    WorldGenerator generator(seed);
+    if(!generator.generate(Terrain_Resource.types,columns,rows,pool,Terrain_Resource.terrain)) {
+        return false;
+    }
+    Terrain_Resource.seed=seed;
+    measure_world(Terrain_Resource);
+    return true;
+}
+
+//---------Camera_Functions------------------------
+
+//Finds the tile the mouse is over with the picker, which costs the same on any size of map. tile_location is the top
+//left of that tile as it is drawn, and left/right are how far the tiles in front of it are raised, which picks the
+//cursor sprite. All of them are -1 when the mouse is off the map.
+
+void GetMouseLocation(Mouse_Resources &Mouse_Resource, const HexPicker &picker, const TerrainGrid &tiles, int &left, int &right) {
+    int x=Mouse_Resource.x/Mouse_Resource.zoom-(Mouse_Resource.x_modifier); int y=(Mouse_Resource.y-30)/Mouse_Resource.zoom-(Mouse_Resource.y_modifier); //get mouse x,y on the map
+    int column, row;
+    if(!picker.pick(tiles,x,y,column,row)) {
+        left=-1;
+        right=-1;
+        Mouse_Resource.column=-1;
+        Mouse_Resource.row=-1;
+        return;
+    }
+    int level=tiles.returnLevel(column,row);
+    int south_west=tiles.neighbour(column,row,TerrainGrid::SOUTH_WEST);
+    int south_east=tiles.neighbour(column,row,TerrainGrid::SOUTH_EAST);
+    left=south_west!=-1 ? std::max(tiles.returnLevel(south_west)-level,0) : 0;
+    right=south_east!=-1 ? std::max(tiles.returnLevel(south_east)-level,0) : 0;
+    Mouse_Resource.column=column;
+    Mouse_Resource.row=row;
+    Mouse_Resource.tile_location_x=picker.returnX(column,row);
+    Mouse_Resource.tile_location_y=picker.returnY(row,level);
+}
+
+//this function moves the camera when the user hovers over the edge of the map. The speeds are in screen pixels per
+//second, so the camera crosses the screen in the same time at any frame rate and zoom. Parts of a map pixel carry
+//over to the next frame. Returns whether the camera moved, which it doesn't at the edge of the map.
+
+bool UpdateCamera(Mouse_Resources &Mouse_Resource, Terrain_Resources &Terrain_Resource, float seconds, int screen_width, int screen_height) {
+    const float slow=240, fast=720;
+    float x=0, y=0;
+    if(Mouse_Resource.x<10){//Moves Left based on proximity to edge
+        x=fast;
+    }
+    else if(Mouse_Resource.x<20){//Moves Left based on proximity to edge
+        x=slow;
+    }
+    if(Mouse_Resource.x>screen_width-10) {//Moves Right based on proximity to edge
+        x=-fast;
+    }
+    else if(Mouse_Resource.x>screen_width-20) {//Moves Right based on proximity to edge
+        x=-slow;
+    }
+    if(Mouse_Resource.y<40 && Mouse_Resource.y>30) {//Moves Up based on proximity to edge
+        y=fast;
+    }
+    else if(Mouse_Resource.y<50 && Mouse_Resource.y>30) {//Moves Up based on proximity to edge
+        y=slow;
+    }
+    if(Mouse_Resource.y>screen_height-10) {//Moves Down based on proximity to edge
+        y=-fast;
+    }
+    else if(Mouse_Resource.y>screen_height-20) {//Moves Down based on proximity to edge
+        y=-slow;
+    }
+    if(x==0 && y==0) {
+        Mouse_Resource.x_carry=Mouse_Resource.y_carry=0;
+        return 0;
+    }
+    Mouse_Resource.x_carry+=x*seconds/Mouse_Resource.zoom;
+    Mouse_Resource.y_carry+=y*seconds/Mouse_Resource.zoom;
+    int dx=(int)Mouse_Resource.x_carry, dy=(int)Mouse_Resource.y_carry;
+    Mouse_Resource.x_carry-=dx;
+    Mouse_Resource.y_carry-=dy;
+    int x_before=Mouse_Resource.x_modifier, y_before=Mouse_Resource.y_modifier;
+    Mouse_Resource.x_modifier+=dx;
+    Mouse_Resource.y_modifier+=dy;
+    ClampCamera(Mouse_Resource,Terrain_Resource,screen_width,screen_height);
+    if(Mouse_Resource.x_modifier==x_before && Mouse_Resource.y_modifier==y_before && (dx!=0 || dy!=0)) { //pinned at the edge
+        Mouse_Resource.x_carry=Mouse_Resource.y_carry=0;
+        return 0;
+    }
+    return 1;
+}
+
+//Keeps the camera on the map
+
+void ClampCamera(Mouse_Resources &Mouse_Resource, Terrain_Resources &Terrain_Resource, int screen_width, int screen_height) {
+    int view_width=screen_width/Mouse_Resource.zoom;
+    int view_height=(screen_height-30)/Mouse_Resource.zoom;
+    if(Mouse_Resource.x_modifier<-Terrain_Resource.world_width+view_width) {
+        Mouse_Resource.x_modifier=-Terrain_Resource.world_width+view_width;
+    }
+    if(Mouse_Resource.y_modifier<-Terrain_Resource.world_height+view_height) {
+        Mouse_Resource.y_modifier=-Terrain_Resource.world_height+view_height;
+    }
+    if(Mouse_Resource.y_modifier>0) { //Prevents the user from leaving the map
+        Mouse_Resource.y_modifier=0;
+    }
+    if(Mouse_Resource.x_modifier>0) { //Prevents the user from leaving the map
+        Mouse_Resource.x_modifier=0;
+    }
+}
+
+//Zooms by steps of the mouse wheel, keeping the point of the map under the mouse where it is. The zoom stops where
+//the whole map fits on the screen.
+
+void ZoomCamera(Mouse_Resources &Mouse_Resource, Terrain_Resources &Terrain_Resource, int steps, int screen_width, int screen_height) {
+    float smallest=std::max((float)screen_width/Terrain_Resource.world_width,(float)(screen_height-30)/Terrain_Resource.world_height);
+    smallest=std::min(std::max(smallest,0.125f),1.0f);
+    float zoom=Mouse_Resource.zoom;
+    for(int i=0;i<abs(steps);i++) {
+        zoom*=steps>0 ? 1.125f : 1/1.125f;
+    }
+    zoom=std::min(std::max(zoom,smallest),2.0f);
+    float x=Mouse_Resource.x/Mouse_Resource.zoom-Mouse_Resource.x_modifier;
+    float y=(Mouse_Resource.y-30)/Mouse_Resource.zoom-Mouse_Resource.y_modifier;
+    Mouse_Resource.zoom=zoom;
+    Mouse_Resource.x_modifier=(int)(Mouse_Resource.x/zoom-x);
+    Mouse_Resource.y_modifier=(int)((Mouse_Resource.y-30)/zoom-y);
+    ClampCamera(Mouse_Resource,Terrain_Resource,screen_width,screen_height);
+}
+
+//Queues every tile that reaches into area (in map pixels) with the corner of area at 0,0, each drawn zoom times its
+//size. Rows are queued top to bottom, a batch layer each, so raised tiles cover the row behind them. Tiles of one row
+//don't overlap, so each row is drawn with one call per atlas page it uses. Both edges of a tile are scaled so shrunk
+//tiles still meet without gaps. With animate, tiles that animate show the variant for the time now and the time the
+//soonest of them changes is returned, otherwise every tile shows its own variant and 0 is returned.
+
+static Uint32 queue_map_region(SDL_Rect area, float zoom, bool animate, Uint32 now, Terrain_Resources &Terrain_Resource, Atlas &atlas, SpriteBatch &batch) {
+    int first_row=std::max(area.y/28-1,0);
+    int last_row=std::min((area.y+area.h+Terrain_Resource.tallest)/28,Terrain_Resource.rows-1);
+    int first_column=std::max(area.x/Terrain_Resource.width-1,0);
+    int last_column=std::min((area.x+area.w)/Terrain_Resource.width,Terrain_Resource.columns-1);
+    int placex, placey;
+    TerrainGrid &terrain=Terrain_Resource.terrain;
+    TileDatabase &database=Terrain_Resource.types;
+    //Variants every type is moved on by at now, and which animating types were queued
+    int frames[256];
+    bool shown[256];
+    for(int type=0;type<database.returnCount();type++) {
+        frames[type]=animate && database.returnFrameTime(type)>0 ? now/database.returnFrameTime(type) : 0;
+        shown[type]=false;
+    }
+    for(int row=first_row;row<=last_row;row++) {
+        const uint8_t* types=terrain.returnTypeRow(row);
+        const uint8_t* variants=terrain.returnVariantRow(row);
+        batch.setLayer(row,false);
+        for(int column=first_column;column<=last_column;column++) {
+            int type=database.returnLower(types[column],Terrain_Resource.view_level);
+            int group=database.returnTextures(type);
+            const Sprite &sprite=atlas.returnSprite(group,(variants[column]+frames[type])%atlas.returnVariants(group));
+            shown[type]=true;
+            placex=column*Terrain_Resource.width+(row%2)*Terrain_Resource.width/2-area.x;
+            placey=row*28+Terrain_Resource.height-sprite.rect.h-area.y;
+            int left=(int)std::floor(placex*zoom), top=(int)std::floor(placey*zoom);
+            batch.add(sprite,left,top,(int)std::floor((placex+sprite.rect.w)*zoom)-left,(int)std::floor((placey+sprite.rect.h)*zoom)-top);
+        }
+    }
+    Uint32 due=0;
+    for(int type=0;animate && type<database.returnCount();type++) {
+        Uint32 frame_time=database.returnFrameTime(type);
+        if(shown[type] && frame_time>0 && atlas.returnVariants(database.returnTextures(type))>1) {
+            Uint32 next=(now/frame_time+1)*frame_time;
+            if(due==0 || next<due) {
+                due=next;
+            }
+        }
+    }
+    return due;
+}
+
+//Draws area into the current render target for a chunk, shrunk by scale for zoomed out chunks. A chunk looks exactly
+//like the same part of a full map bake, animated tiles are baked with their own variant.
+
+void bake_map_region(SDL_Renderer* Renderer, SDL_Rect area, int scale, Terrain_Resources &Terrain_Resource, Atlas &atlas, SpriteBatch &batch) {
+    queue_map_region(area,1.0f/scale,false,0,Terrain_Resource,atlas,batch);
+    batch.flush(Renderer);
+}
+
+//Queues the camera rect of the map at 0,0 of the batch's viewport without any baked chunks, so the cost is the tiles
+//on the screen however big the map is and animated tiles can move. The rows take batch layers 0 up to the number of
+//rows. Returns when an animated tile in view next changes (SDL_GetTicks() time), 0 if none is in view.
+
+Uint32 queue_map_view(SDL_Rect camera, float zoom, Uint32 now, Terrain_Resources &Terrain_Resource, Atlas &atlas, SpriteBatch &batch) {
+    return queue_map_region(camera,zoom,true,now,Terrain_Resource,atlas,batch);
+}
+
+//Builds the minimap pyramid from the tiles on the worker threads
+
+bool build_minimap(Minimap &minimap, Terrain_Resources &Terrain_Resource, ThreadPool &pool) {
+    return minimap.build(Terrain_Resource.terrain,Terrain_Resource.picker,Terrain_Resource.colours,Terrain_Resource.world_width,Terrain_Resource.world_height,pool);
+}
+
+//---------Editing_Functions------------------------
+
+//Changes the type of a tile and remembers it, nothing is drawn until redraw_changed_tiles
+
+bool change_tile(Terrain_Resources &Terrain_Resource, int column, int row, int type) {
+    TerrainGrid &terrain=Terrain_Resource.terrain;
+    TileDatabase &types=Terrain_Resource.types;
+    if(!terrain.contains(column,row) || type<0 || type>=types.returnCount()) {
+        return false;
+    }
+    terrain.setTile(column,row,type,TerrainGrid::variantFor(Terrain_Resource.seed,column,row,type),types.returnLevel(type),types.returnMobility(type));
+    Terrain_Resource.changed.push_back(terrain.index(column,row));
+    return true;
+}
+
+//Redraws the changed tiles in the resident chunks and the minimap. A tile covers its footprint and up to the
+//tallest texture above it, so that rect is drawn again with every tile reaching into it, which brings back the
+//neighbours it overlaps in the right order. Rects that touch are merged so a brush stroke is a few redraws.
+
+void redraw_changed_tiles(SDL_Renderer* Renderer, Terrain_Resources &Terrain_Resource, ChunkCache &layers, Minimap &minimap) {
+    std::vector<SDL_Rect> areas;
+    TerrainGrid &terrain=Terrain_Resource.terrain;
+    for(int i=0;i<(int)Terrain_Resource.changed.size();i++) {
+        int column=terrain.returnColumn(Terrain_Resource.changed[i]);
+        int row=terrain.returnRow(Terrain_Resource.changed[i]);
+        int bottom=row*28+Terrain_Resource.height;
+        SDL_Rect area={column*Terrain_Resource.width+(row%2)*Terrain_Resource.width/2,bottom-Terrain_Resource.tallest,Terrain_Resource.width,Terrain_Resource.tallest};
+        //Merge with every rect it touches until it touches none
+        for(int j=0;j<(int)areas.size();) {
+            SDL_Rect grown={areas[j].x-1,areas[j].y-1,areas[j].w+2,areas[j].h+2};
+            if(SDL_HasIntersection(&grown,&area)) {
+                SDL_UnionRect(&areas[j],&area,&area);
+                areas.erase(areas.begin()+j);
+                j=0;
+            }
+            else {
+                j++;
+            }
+        }
+        areas.push_back(area);
+    }
+    Terrain_Resource.changed.clear();
+    for(int i=0;i<(int)areas.size();i++) {
+        layers.redraw(Renderer,areas[i]);
+        minimap.update(Terrain_Resource.terrain,Terrain_Resource.picker,Terrain_Resource.colours,areas[i]);
+    }
+}
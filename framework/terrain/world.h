@@ -0,0 +1,64 @@
+#ifndef WORLD_H
+#define WORLD_H
+
+//The map as the game sees it: loading tiles and maps, picking the tile under the mouse, moving the camera and
+//drawing terrain. Shared by the game and the tools so both run exactly the same code.
+
+struct Mouse_Resources {
+    int x,y; //current x and y coordinates
+    int tile_location_x, tile_location_y; //current tile coordinates
+    int column=-1, row=-1; //tile under the mouse, -1 when off the map
+    int x_modifier=0; //x scroll modifier
+    int y_modifier=0; //y scroll modifier
+    float zoom=1.0f; //screen pixels per map pixel
+    float x_carry=0, y_carry=0; //scrolling of less than a map pixel still to be done
+};
+
+struct Terrain_Resources {
+    int size=100;
+    int width=50;
+    int height=40;
+    int columns=0, rows=0; //map size in tiles
+    uint32_t seed=0; //picks the texture variant of every tile
+    int world_width=0, world_height=0; //map size in pixels
+    int tallest=0; //height of the tallest terrain texture, tiles reach this far up into the row behind
+    TerrainGrid terrain; //type, variant, level and mobility of every tile
+    TileDatabase types; //compiled tile definitions, indexed by tile type id
+    HexPicker picker; //maps pixels of the map to tiles
+    int view_level=TileDatabase::LEVELS-1; //tiles above this level are drawn as the tile below them
+    std::vector<int> changed; //tiles edited since they were last drawn
+    std::vector<Uint32> colours; //minimap colour of every tile type
+    std::vector<std::pair<std::string,std::vector<std::string> > > terrain_type_information;
+};
+
+struct Texture_File {
+    int group, variant; //atlas slot the image goes into
+    std::string path;
+};
+
+//Textures
+void scan_textures(std::string location, std::string group, Atlas &atlas, std::vector<Texture_File> &files); //Reserves an atlas slot for every .png under location
+
+//Map
+bool initTiles(std::map<std::string,Tile> &alltiles); //Reads assets/tilesnew.txt
+bool compile_tile_types(std::map<std::string,Tile> &alltiles, Terrain_Resources &Terrain_Resource, Atlas &atlas); //Compiles the tile definitions and finds their textures
+void measure_tile_types(Terrain_Resources &Terrain_Resource, Atlas &atlas); //Finds the tallest terrain texture and the colour of every type
+bool map_parse(Terrain_Resources &Terrain_Resource, std::string location); //Loads a text or binary map
+bool generate_world(Terrain_Resources &Terrain_Resource, int columns, int rows, uint32_t seed, ThreadPool &pool); //Generates a map from a seed
+
+//Camera
+void GetMouseLocation(Mouse_Resources &Mouse_Resource, const HexPicker &picker, const TerrainGrid &tiles, int &left, int &right); //Finds the tile under the mouse
+bool UpdateCamera(Mouse_Resources &Mouse_Resource, Terrain_Resources &Terrain_Resource, float seconds, int screen_width, int screen_height); //Scrolls for seconds when the mouse is near an edge, false unless it is still scrolling
+void ClampCamera(Mouse_Resources &Mouse_Resource, Terrain_Resources &Terrain_Resource, int screen_width, int screen_height); //Keeps the camera on the map
+void ZoomCamera(Mouse_Resources &Mouse_Resource, Terrain_Resources &Terrain_Resource, int steps, int screen_width, int screen_height); //Zooms around the mouse
+
+//Rendering
+void bake_map_region(SDL_Renderer* Renderer, SDL_Rect area, int scale, Terrain_Resources &Terrain_Resource, Atlas &atlas, SpriteBatch &batch); //Draws the tiles in area shrunk by scale
+Uint32 queue_map_view(SDL_Rect camera, float zoom, Uint32 now, Terrain_Resources &Terrain_Resource, Atlas &atlas, SpriteBatch &batch); //Queues the tiles in camera for this frame, returns when an animated one next changes
+bool build_minimap(Minimap &minimap, Terrain_Resources &Terrain_Resource, ThreadPool &pool); //Builds the minimap pyramid from the tiles
+
+//Editing
+bool change_tile(Terrain_Resources &Terrain_Resource, int column, int row, int type); //Changes a tile and marks it changed
+void redraw_changed_tiles(SDL_Renderer* Renderer, Terrain_Resources &Terrain_Resource, ChunkCache &layers, Minimap &minimap); //Draws the changed tiles again
+
+#endif // WORLD_H
@@ -0,0 +1,154 @@
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <math.h>
+#include <stdint.h>
+#include "../core/threadpool.h"
+#include "../interface/tile.h"
+#include "terraingrid.h"
+#include "tiledatabase.h"
+#include "worldgen.h"
+
+static const char* biome_names[WorldGenerator::BIOMES] = {"deep_ocean","shallow_ocean","plain","grassland","desert","marsh","forest","jungle","hill","mountain","peak"};
+
+//Biome drawn instead when a tile set has no type for one, followed until a type is found
+static const int biome_fallbacks[WorldGenerator::BIOMES] = {WorldGenerator::SHALLOW_OCEAN, WorldGenerator::DEEP_OCEAN, WorldGenerator::GRASSLAND, WorldGenerator::PLAIN,
+    WorldGenerator::PLAIN, WorldGenerator::GRASSLAND, WorldGenerator::GRASSLAND, WorldGenerator::FOREST, WorldGenerator::PLAIN, WorldGenerator::HILL, WorldGenerator::MOUNTAIN};
+
+static const float row_spacing=0.56f; //rows are 28 pixels apart on tiles 50 pixels wide
+
+WorldGenerator::WorldGenerator(uint32_t seed_) {
+    seed=seed_;
+    scale=64.0f;
+    octaves=5;
+    sea_level=0.45f;
+}
+
+bool WorldGenerator::generate(const TileDatabase &types, int columns, int rows, ThreadPool &pool, TerrainGrid &grid) const {
+    if(columns<=0 || rows<=0) {
+        printf("Can't generate a %dx%d map.\n",columns,rows);
+        return false;
+    }
+    int ids[BIOMES];
+    for(int biome=0;biome<BIOMES;biome++) {
+        int next=biome;
+        ids[biome]=types.find(biome_names[next]);
+        for(int i=0;i<BIOMES && ids[biome]==-1;i++) {
+            next=biome_fallbacks[next];
+            ids[biome]=types.find(biome_names[next]);
+        }
+        if(ids[biome]==-1) {
+            printf("No tile type to draw %s with.\n",biome_names[biome]);
+            return false;
+        }
+    }
+    grid.resize(columns,rows);
+    for(int first=0;first<rows;first+=BAND) {
+        int last=std::min(first+(int)BAND,rows);
+        pool.push([this,&ids,&types,first,last,&grid]() {
+            generateRows(ids,types,first,last,grid);
+        });
+    }
+    pool.wait();
+    return true;
+}
+
+void WorldGenerator::generateRows(const int ids[BIOMES], const TileDatabase &types, int first, int last, TerrainGrid &grid) const {
+    int columns=grid.returnColumns();
+    for(int row=first;row<last;row++) {
+        float y=row*row_spacing;
+        for(int column=0;column<columns;column++) {
+            float x=column+(row&1)*0.5f;
+            float height=elevation(x,y);
+            float wet=height<sea_level ? 0 : moisture(x,y); //the sea doesn't need it
+            int id=ids[classify(height,wet)];
+            grid.setTile(column,row,id,TerrainGrid::variantFor(seed,column,row,id),types.returnLevel(id),types.returnMobility(id));
+        }
+    }
+}
+
+float WorldGenerator::elevation(float x, float y) const {
+    //Octaves pile up around 0.5, stretched so the bands below get a useful share of the map
+    float height=(fractal(seed,x/scale,y/scale)-0.5f)*1.8f+0.5f;
+    return std::max(0.0f,std::min(1.0f,height));
+}
+
+float WorldGenerator::moisture(float x, float y) const {
+    float wet=(fractal(seed^0x5BD1E995u,x*2/scale,y*2/scale)-0.5f)*2.5f+0.5f;
+    return std::max(0.0f,std::min(1.0f,wet));
+}
+
+WorldGenerator::Biome WorldGenerator::classify(float elevation, float moisture) const {
+    if(elevation<sea_level-0.1f) {
+        return DEEP_OCEAN;
+    }
+    if(elevation<sea_level) {
+        return SHALLOW_OCEAN;
+    }
+    float land=(elevation-sea_level)/(1-sea_level); //0 at the coast, 1 at the highest peaks
+    if(land>0.8f) {
+        return PEAK;
+    }
+    if(land>0.62f) {
+        return MOUNTAIN;
+    }
+    if(land>0.42f) {
+        return moisture>0.65f ? JUNGLE : HILL;
+    }
+    if(moisture>0.7f && land<0.12f) {
+        return MARSH;
+    }
+    if(moisture<0.3f) {
+        return DESERT;
+    }
+    if(moisture<0.45f) {
+        return PLAIN;
+    }
+    if(moisture<0.6f) {
+        return GRASSLAND;
+    }
+    return FOREST;
+}
+
+const char* WorldGenerator::returnName(int biome) {
+    return biome_names[biome];
+}
+
+float WorldGenerator::noise(uint32_t seed, float x, float y) {
+    float fx=floorf(x), fy=floorf(y);
+    int ix=(int)fx, iy=(int)fy;
+    float tx=x-fx, ty=y-fy;
+    tx=tx*tx*(3-2*tx);
+    ty=ty*ty*(3-2*ty);
+    //Random value at every lattice point, from a hash of the seed and the point
+    float corners[4];
+    for(int i=0;i<4;i++) {
+        uint32_t h=seed^((uint32_t)(ix+(i&1))*0x27D4EB2Du)^((uint32_t)(iy+(i>>1))*0x165667B1u);
+        h^=h>>15;
+        h*=0x2C1B3C6Du;
+        h^=h>>12;
+        h*=0x297A2D39u;
+        h^=h>>15;
+        corners[i]=(h>>8)*(1.0f/16777216.0f);
+    }
+    float top=corners[0]+(corners[1]-corners[0])*tx;
+    float bottom=corners[2]+(corners[3]-corners[2])*tx;
+    return top+(bottom-top)*ty;
+}
+
+float WorldGenerator::fractal(uint32_t seed, float x, float y) const {
+    float total=0, weight=0, amplitude=1;
+    for(int i=0;i<octaves;i++) {
+        total+=noise(seed+i*0x68E31DA4u,x,y)*amplitude;
+        weight+=amplitude;
+        amplitude*=0.5f;
+        x*=2;
+        y*=2;
+    }
+    return weight>0 ? total/weight : 0.5f;
+}
@@ -0,0 +1,47 @@
+#ifndef WORLDGEN_H
+#define WORLDGEN_H
+
+//Generates maps of any size from a seed. Elevation and moisture are octaves of value noise sampled at the centre of
+//every hex, and each tile takes the type of the band its elevation and moisture fall in. Every tile depends only on
+//the seed and its position, so bands of rows are generated on worker threads in any order and the same seed always
+//gives the same map.
+
+class WorldGenerator {
+public:
+    enum {BAND=32}; //rows generated by one job
+    enum Biome {DEEP_OCEAN, SHALLOW_OCEAN, PLAIN, GRASSLAND, DESERT, MARSH, FOREST, JUNGLE, HILL, MOUNTAIN, PEAK, BIOMES};
+
+    //Constructors & Deconstructors
+    WorldGenerator(uint32_t seed_=0); //Default Constructor
+
+    //Generating
+    bool generate(const TileDatabase &types, int columns, int rows, ThreadPool &pool, TerrainGrid &grid) const; //Fills grid with a new map, not from a job on pool
+    float elevation(float x, float y) const; //0 to 1, x and y in tiles
+    float moisture(float x, float y) const; //0 to 1, x and y in tiles
+    Biome classify(float elevation, float moisture) const; //Biome of a tile
+
+    //Accessors
+    uint32_t returnSeed() const {return seed;}
+    float returnScale() const {return scale;}
+    int returnOctaves() const {return octaves;}
+    float returnSeaLevel() const {return sea_level;}
+    static const char* returnName(int biome); //Tile type the biome is drawn as
+
+    //Modifiers
+    void setSeed(uint32_t seed_) {seed=seed_;}
+    void setScale(float tiles) {scale=tiles;} //Size of the largest continents and ranges in tiles
+    void setOctaves(int count) {octaves=count;}
+    void setSeaLevel(float level) {sea_level=level;} //Elevation below which tiles are ocean
+
+private:
+    static float noise(uint32_t seed, float x, float y); //Smoothed value noise, 0 to 1, one lattice point per unit
+    float fractal(uint32_t seed, float x, float y) const; //octaves of noise, each twice as fine and half as strong
+    void generateRows(const int ids[BIOMES], const TileDatabase &types, int first, int last, TerrainGrid &grid) const;
+
+    uint32_t seed;
+    float scale;
+    int octaves;
+    float sea_level;
+};
+
+#endif // WORLDGEN_H
@@ -4,6 +4,11 @@
 #include <fstream>
 #include <vector>
 #include <map>
+#include <algorithm>
+#include <stdint.h>
+#include <functional>
+#include <deque>
+#include <memory>
 #include <stdlib.h>
 //SDL2 C++ Libraries
 
@@ -16,34 +21,58 @@
 #include <boost/filesystem.hpp>
 
 //Custom Interface Classes
+#include "framework/core/threadpool.h"
+#include "framework/core/taskgraph.h"
+#include "framework/core/profiler.h"
+#include "framework/render/texturecache.h"
+#include "framework/render/atlas.h"
+#include "framework/render/spritebatch.h"
+#include "framework/render/font.h"
+#include "framework/render/renderscheduler.h"
 #include "framework/interface/texture.h"
 #include "framework/interface/button.h"
+#include "framework/interface/checkbox.h"
+#include "framework/interface/eventrouter.h"
 #include "framework/interface/window.h"
 #include "framework/interface/tile.h"
-#include "framework/interface/checkbox.h"
+#include "framework/terrain/chunkcache.h"
+#include "framework/terrain/terraingrid.h"
+#include "framework/terrain/tiledatabase.h"
+#include "framework/terrain/mapfile.h"
+#include "framework/terrain/picking.h"
+#include "framework/terrain/minimap.h"
+#include "framework/terrain/world.h"
+#include "framework/sim/simulation.h"
+#include "framework/sim/simthread.h"
 
 //Screen dimension constants (will default to 640x480 if none are defined in config.ini
 int SCREEN_WIDTH = 640;
 int SCREEN_HEIGHT = 480;
 
+//Profiler settings (PROFILE 1 shows the overlay and dumps the history on exit, PROFILE_CSV is the file F12 writes to)
+bool PROFILE = false;
+std::string PROFILE_CSV = "profile.csv";
+
+//Map settings (GENERATE_COLUMNS above 0 generates a world from SEED in place of map.map, SEED also picks the variants,
+//ANIMATE_TERRAIN 1 draws the tiles in view every frame in place of the baked chunks so animated tiles move,
+//EDITOR 1 lets right clicking a tile change its type)
+int GENERATE_COLUMNS = 0;
+int GENERATE_ROWS = 0;
+unsigned int SEED = 0;
+bool ANIMATE_TERRAIN = false;
+bool EDITOR = false;
+
+//Simulation settings (SETTLEMENTS is the number founded at startup, TICK_MS the time between simulation ticks)
+int SETTLEMENTS = 200;
+int TICK_MS = 100;
+
 //Global Variables
 SDL_Renderer* Renderer = NULL;
 SDL_Window* window = NULL;
 SDL_Surface* ScreenSurface = NULL;
 
-struct Mouse_Resources {
-    int x,y; //current x and y coordinates
-    int tile_location_x, tile_location_y; //current tile coordinates
-    int x_modifier=0; //x scroll modifier
-    int y_modifier=0; //y scroll modifier
-};
-
-struct Terrain_Resources {
-    int size=100;
-    int width=50;
-    int height=40;
-    std::vector<Tile> terrain_individual_information;
-    std::vector<std::pair<std::string,std::vector<std::string> > > terrain_type_information;
+struct Startup_Resources {
+    bool config=false, sdl=false, window=false, textures=false, tiles=false, map=false; //which stages of startup succeeded
 };
 
 static const char *arrow[] = {
@@ -122,39 +151,6 @@ static SDL_Cursor *init_system_cursor(const char *image[])
   sscanf(image[4+row], "%d,%d", &hot_x, &hot_y);
   return SDL_CreateCursor(data, mask, 32, 32, hot_x, hot_y);
 }
-//---------Text_Functions------------------------
-
-int loadFromRenderedText(SDL_Renderer* Renderer,  std::string textureText, TTF_Font* Font, SDL_Color textColor, int x, int y) {
-    SDL_Texture* texture;
-    int Width;
-    int Height;
-    //Get rid of preexisting texture
-
-    //Render text surface
-    SDL_Surface* textSurface = TTF_RenderText_Solid( Font, textureText.c_str(), textColor );
-    if( textSurface == NULL ) {
-        printf( "Unable to render text surface! SDL_ttf Error: %s\n", TTF_GetError() );
-    }
-    else {
-        //Create texture from surface pixels
-        texture = SDL_CreateTextureFromSurface(Renderer, textSurface );
-        if( texture == NULL ) {
-            printf( "Unable to create texture from rendered text! SDL Error: %s\n", SDL_GetError() );
-        }
-        else {
-            //Get image dimensions
-            Width = textSurface->w;
-            Height = textSurface->h;
-        }
-
-        //Get rid of old surface
-        SDL_FreeSurface( textSurface );
-    }
-    SDL_Rect renderQuad = { x, y, Width, Height };
-    SDL_RenderCopy(Renderer,texture, NULL, &renderQuad );
-    return Height;
-}
-
 //---------Initializations------------------------
 
 
@@ -179,6 +175,33 @@ bool initConfig() {
     if(config.find("SCREEN_HEIGHT")!=config.end()) { //Checks for SCREEN_HEIGHT
         SCREEN_HEIGHT=std::atoi(config.find("SCREEN_HEIGHT")->second.c_str());
     }
+    if(config.find("PROFILE")!=config.end()) { //Checks for PROFILE
+        PROFILE=std::atoi(config.find("PROFILE")->second.c_str())!=0;
+    }
+    if(config.find("PROFILE_CSV")!=config.end()) { //Checks for PROFILE_CSV
+        PROFILE_CSV=config.find("PROFILE_CSV")->second;
+    }
+    if(config.find("GENERATE_COLUMNS")!=config.end()) { //Checks for GENERATE_COLUMNS
+        GENERATE_COLUMNS=std::atoi(config.find("GENERATE_COLUMNS")->second.c_str());
+    }
+    if(config.find("GENERATE_ROWS")!=config.end()) { //Checks for GENERATE_ROWS
+        GENERATE_ROWS=std::atoi(config.find("GENERATE_ROWS")->second.c_str());
+    }
+    if(config.find("SEED")!=config.end()) { //Checks for SEED
+        SEED=std::strtoul(config.find("SEED")->second.c_str(),NULL,10);
+    }
+    if(config.find("ANIMATE_TERRAIN")!=config.end()) { //Checks for ANIMATE_TERRAIN
+        ANIMATE_TERRAIN=std::atoi(config.find("ANIMATE_TERRAIN")->second.c_str())!=0;
+    }
+    if(config.find("EDITOR")!=config.end()) { //Checks for EDITOR
+        EDITOR=std::atoi(config.find("EDITOR")->second.c_str())!=0;
+    }
+    if(config.find("SETTLEMENTS")!=config.end()) { //Checks for SETTLEMENTS
+        SETTLEMENTS=std::atoi(config.find("SETTLEMENTS")->second.c_str());
+    }
+    if(config.find("TICK_MS")!=config.end()) { //Checks for TICK_MS
+        TICK_MS=std::max(std::atoi(config.find("TICK_MS")->second.c_str()),1);
+    }
     return true;
 }
 
@@ -233,185 +256,79 @@ bool initWindow() {
     return true;
 }
 
-bool initTextures(std::map<std::string,std::vector<Texture> > &alltextures) {
-    boost::filesystem::path path("../Settlements/assets/textures");
-    boost::filesystem::directory_iterator b(path), e;
-    std::vector<boost::filesystem::path> directory(b, e);
-    std::vector<Texture> tmp;
-    for(int i=0; i<directory.size();i++) {
-        b=boost::filesystem::directory_iterator(directory[i]), e;
-        std::vector<boost::filesystem::path> subtexture(b, e);
-        std::string s=directory[i].string();
-        s.replace(s.begin(),s.begin()+path.string().size()+1,"");
-        std::sort(subtexture.begin(),subtexture.end());
-        for(int j=0;j<subtexture.size();j++) {
-            if(subtexture[j].extension().string()==".png") {
-                tmp.push_back(Texture(Renderer,subtexture[j].string()));
-            }
-        }
-        alltextures.insert(std::pair<std::string,std::vector<Texture> >(s,tmp));
-        tmp.clear();
-    }
-    return true;
-}
+//---------Startup------------------------
 
-bool initTiles(std::map<std::string,Tile> &alltiles) {
-    std::ifstream f_tiles("../Settlements/assets/tilesnew.txt");
-    if (!f_tiles.good()) {
-        printf("Can't open tiles.txt.\n");
-        return false;
-    }
-    std::string buffer, name;
-    while(!f_tiles.eof()) {
-        f_tiles>>buffer;
-        if(buffer[0]=='<') {
-            name=buffer;
-            name.replace(name.begin(),name.begin()+1,"");
-            alltiles.insert(std::pair<std::string,Tile>(name,Tile(name)));
-        }
-        else if(buffer[0]=='>') {
-            buffer.replace(buffer.begin(),buffer.begin()+1,"");
-            if(buffer=="capacity") {
-                f_tiles>>buffer;
-                alltiles.find(name)->second.setCapacity(std::atoi(buffer.c_str()));
-            }
-            else if(buffer=="mobility") {
-                f_tiles>>buffer;
-                alltiles.find(name)->second.setMobility(std::atoi(buffer.c_str()));
-            }
-            else if(buffer=="level") {
-                f_tiles>>buffer;
-                alltiles.find(name)->second.setLevel(std::atoi(buffer.c_str()));
-            }
-            else if(buffer=="below") {
-                f_tiles>>buffer;
-                alltiles.find(name)->second.setBelow(buffer);
-            }
-        }
-    }
-    return true;
-}
-
-//---------Map_Functions------------------------
+//Loads everything needed before the first frame as a graph of tasks. The config, tile definitions, map and every
+//PNG are read on worker threads, while the main thread creates the window and uploads the atlas once both are ready.
+//Startup takes as long as the slowest chain of stages instead of the sum of all of them.
 
-bool map_parse(std::map<std::string,Tile> alltiles, std::vector<Tile> &map_info, std::string location, std::map<std::string,std::vector<Texture> > &textures1) {
-    int w, h;
-    std::ifstream map(location.c_str());
-    if (!map.good()) {
-        printf("Can't open map.txt.\n");
-        return false;
-    }
-    int x=0;int y=0;
-    std::map<int,std::string> maps;
-    std::string value,name;
-    map >> w;
-    map >> h;
-    while(!map.eof()) {
-        map >> value;
-        if(value[0]=='>') {
-            value.replace(value.begin(),value.begin()+1,"");
-            name=value;
-            map>>value;
-            maps.insert(std::pair<int,std::string>(std::atoi(name.c_str()),value));
-        }
-        else if(value!="/") {
-            int value_=std::atoi(value.c_str());
-            std::string value1= maps.find(value_)->second;
-            int random=rand()%(textures1.find(value1)->second.size());
-            Tile t(alltiles.find(value1)->second,random,x,y);
-            map_info.push_back(t);
-            x+=50;
-        }
-        else {
-            if(x%100==0) {
-                x=25;
-            }
-            else {
-                x=0;
-            }
-            y+=28;
-        }
+void initStartup(Startup_Resources &Startup, ThreadPool &pool, std::map<std::string,Tile> &tiles, Atlas &atlas, Terrain_Resources &Terrain_Resource) {
+    //SDL_image has to be initialized before images are decoded on several threads at once
+    Startup.sdl=initSDL();
+    if(!Startup.sdl) {
+        Startup.config=initConfig();
+        return;
     }
-    return true;
-}
-
-
-//---------Camera_Functions------------------------
-
-//This function returns the tile location that the mouse is currently hovering over. Each hexagon is split into rectangles
-//to find the general mouse position. After that, each triangle of the hexagon is checked and the general mouse position is
-//fixed.
-
-void GetMouseLocation(Mouse_Resources &Mouse_Resource, int width, int height, std::vector<Tile> tiles, int &left, int &right) {
-    left=0;right=0;
-    right=0;left=0;
-    width=width;
-    height=height;
-    int x_half=width*.5; //half the tile width
-    int y_rect=28; //70% of the tile height
-    int y_tri=height-y_rect; //top 30% of the tile
-    int x=Mouse_Resource.x-(Mouse_Resource.x_modifier); int y=Mouse_Resource.y-30-(Mouse_Resource.y_modifier); //get mouse x,y
-    int tmp_y=y%y_rect; //count how much remain after 70%s go into the y coordinate of mouse
-    Mouse_Resource.tile_location_y=y/(y_rect); //set y tile location to remainder of 70%s
-    //these if statements deal with the triangle portion of the hexagons
-    if(Mouse_Resource.tile_location_y%2==0) {  //even row =(when row is further left)
-        if(x%width<=x_half) { //left half
-            float line=(x%width)*.48;//slope of hex triangle is .48, used to calculate line
-            if(line<(y_tri-tmp_y)) {//if mouse position is above the line, the tile position is corrected
-                Mouse_Resource.tile_location_y-=1;
-            }
-        }
-        else { //right half
-            float slope=((width-x%width)*.48); //slope of hex triangle is .48, used to calculate line
-            if(slope<(y_tri-tmp_y)) {//if mouse position is above the line, the tile position is corrected
-                Mouse_Resource.tile_location_y-=1;
-            }
-
-        }
-    }
-    else if(Mouse_Resource.tile_location_y%2==1) { //odd row =(when row is further right)
-        if((x-x_half)%width<=x_half) { //left half
-            float slope=((x-x_half)%width)*.48; //slope of hex triangle is .48, used to calculate line
-            if(slope<(y_tri-tmp_y)) {//if mouse position is above the line, the tile position is corrected
-                Mouse_Resource.tile_location_y-=1;
-            }
-        }
-        else { //right half
-            float slope=((width-(x-x_half)%width)*.48); //slope of hex triangle is .48, used to calculate line
-            if(slope<(y_tri-tmp_y)) {//if mouse position is above the line, the tile position is corrected
-                Mouse_Resource.tile_location_y-=1;
-            }
-        }
-    }
-    int num=Mouse_Resource.tile_location_x/(50);
-    int level=tiles[num + Mouse_Resource.tile_location_y*50].returnLevel()*(10);
-    int level1=tiles[num + Mouse_Resource.tile_location_y*50].returnLevel();
-    if (Mouse_Resource.tile_location_y%2==0) {
-        right=(tiles[num + (Mouse_Resource.tile_location_y+1)*50].returnLevel()-level1);
-        if(num>0) {
-            left=(tiles[num + (Mouse_Resource.tile_location_y+1)*50-1].returnLevel()-level1);
-        }
-
+    std::vector<Texture_File> files;
+    boost::filesystem::path path("../Settlements/assets/textures");
+    if(boost::filesystem::is_directory(path)) {
+        scan_textures(path.string(),"",atlas,files);
     }
     else {
-        if(num<49) {
-            right=(tiles[num + (Mouse_Resource.tile_location_y+1)*50+1].returnLevel()-level1);
+        printf("Can't open assets/textures.\n");
+    }
+
+    TaskGraph graph;
+    //Without config.ini the defaults are used, so nothing waiting on it is skipped
+    int config=graph.add([&Startup]() {
+        Startup.config=initConfig();
+        return true;
+    });
+    int window=graph.add([]() {return initWindow();},std::vector<int>(1,config),TaskGraph::MAIN);
+    std::vector<int> decoded;
+    for(int i=0;i<(int)files.size();i++) {
+        Texture_File file=files[i];
+        decoded.push_back(graph.add([&atlas,file]() {
+            SDL_Surface* surface=IMG_Load(file.path.c_str());
+            if(surface==NULL) {
+                printf( "Unable to load image %s! SDL_image Error: %s\n", file.path.c_str(), IMG_GetError() );
+                return false; //the atlas would be missing a sprite, so it isn't packed
+            }
+            atlas.setSurface(file.group,file.variant,surface);
+            return true;
+        }));
+    }
+    int packed=graph.add([&atlas,&files]() {return !files.empty() && atlas.pack();},decoded);
+    std::vector<int> ready;
+    ready.push_back(packed);
+    ready.push_back(window);
+    int uploaded=graph.add([&atlas]() {return atlas.upload(Renderer);},ready,TaskGraph::MAIN);
+    //Fails when a tile type has no textures, nothing that draws or loads the map runs without every type's group
+    int tile_types=graph.add([&tiles,&Terrain_Resource,&atlas]() {
+        if(!initTiles(tiles) || tiles.empty()) {
+            return false;
         }
-        left=(tiles[num + (Mouse_Resource.tile_location_y+1)*50].returnLevel()-level1);
-    }
-    if(Mouse_Resource.tile_location_y%2==0) { //set width for even rows
-        Mouse_Resource.tile_location_x=(x/width)*width;
-    }
-    else { //set width for odd rows
-        Mouse_Resource.tile_location_x=((x-x_half)/width*width)+x_half;
-    }
-    Mouse_Resource.tile_location_y=Mouse_Resource.tile_location_y*y_rect;//set height
-    Mouse_Resource.tile_location_y-=level;
-    if(right<0) right=0;
-    if(left<0) left=0;
-    if(Mouse_Resource.tile_location_y/y_rect>49 || Mouse_Resource.tile_location_x/width>49 || Mouse_Resource.tile_location_y<0) {
-        left=-1;
-        right=-1;
+        return compile_tile_types(tiles,Terrain_Resource,atlas);
+    });
+    std::vector<int> map_needs;
+    map_needs.push_back(config);
+    map_needs.push_back(tile_types);
+    //A generated world is made after the graph, its jobs need the pool to themselves
+    int map=graph.add([&Terrain_Resource]() {
+        Terrain_Resource.seed=SEED;
+        return GENERATE_COLUMNS>0 || map_parse(Terrain_Resource,"..//Settlements//map.map");
+    },map_needs);
+    graph.run(pool);
+
+    Startup.window=graph.returnResult(window);
+    Startup.textures=graph.returnResult(uploaded);
+    Startup.tiles=graph.returnResult(tile_types);
+    Startup.map=graph.returnResult(map);
+    if(Startup.map && GENERATE_COLUMNS>0) {
+        Startup.map=generate_world(Terrain_Resource,GENERATE_COLUMNS,GENERATE_ROWS>0 ? GENERATE_ROWS : GENERATE_COLUMNS,SEED,pool);
+    }
+    if(Startup.textures && Startup.tiles) {
+        measure_tile_types(Terrain_Resource,atlas);
     }
 }
 
@@ -427,263 +344,338 @@ void close() {
     TTF_Quit();
 }
 
-//this function moves the camera when the user hovers over the edge of the map
-
-bool UpdateCamera(Mouse_Resources &Mouse_Resource) {
-    bool moved=0;
-    if(Mouse_Resource.x<10){//Moves Left based on proximity to edge
-        Mouse_Resource.x_modifier+=2;
-        moved=1;
-    }
-    else if(Mouse_Resource.x<20){//Moves Left based on proximity to edge
-        Mouse_Resource.x_modifier+=1;
-        moved=1;
-    }
-    if(Mouse_Resource.x>SCREEN_WIDTH-10) {//Moves Right based on proximity to edge
-        Mouse_Resource.x_modifier-=2;
-        moved=1;
-    }
-    else if(Mouse_Resource.x>SCREEN_WIDTH-20) {//Moves Right based on proximity to edge
-        Mouse_Resource.x_modifier-=1;
-        moved=1;
-    }
-    if(Mouse_Resource.y<40 && Mouse_Resource.y>30) {//Moves Up based on proximity to edge
-        Mouse_Resource.y_modifier+=2;
-        moved=1;
-    }
-    else if(Mouse_Resource.y<50 && Mouse_Resource.y>30) {//Moves Up based on proximity to edge
-        Mouse_Resource.y_modifier+=1;
-        moved=1;
-    }
-    if(Mouse_Resource.y>SCREEN_HEIGHT-10) {//Moves Down based on proximity to edge
-        Mouse_Resource.y_modifier-=2;
-        moved=1;
-    }
-    else if(Mouse_Resource.y>SCREEN_HEIGHT-20) {//Moves Down based on proximity to edge
-        Mouse_Resource.y_modifier-=1;
-        moved=1;
-    }
-    if(Mouse_Resource.y_modifier>0) { //Prevents the user from leaving the map
-        Mouse_Resource.y_modifier=0;
-        moved=1;
-    }
-    if(Mouse_Resource.x_modifier>0) { //Prevents the user from leaving the map
-        Mouse_Resource.x_modifier=0;
-        moved=1;
-    }
-    if(Mouse_Resource.x_modifier<(-50*50-25)+SCREEN_WIDTH) {
-        Mouse_Resource.x_modifier=(-50*50-25)+SCREEN_WIDTH;
-    }
-    if(Mouse_Resource.y_modifier<-50*28-42+(SCREEN_HEIGHT)) {
-        Mouse_Resource.y_modifier=-50*28-42+(SCREEN_HEIGHT);
-    }
-}
-
-std::string getLower(std::map<std::string,Tile> tiles, Tile tile, int j) {
-    while(tiles.find(tile.returnName())->second.returnLevel()>j) {
-        tile=tiles.find(tile.returnBelow())->second;
+//---------Profiler_Functions------------------------
+
+//Draws min/avg/p99 of every phase, the draw counters of the last frame and the simulation thread's last tick. The lines are only rebuilt every quarter
+//second so the font keeps drawing the same cached runs in between.
+
+void render_profile(SpriteBatch &batch, Font &font, const SimThread &ticker, int x, int y) {
+    static std::vector<std::string> lines;
+    static Uint32 updated=0;
+    Profiler &profiler=Profiler::instance();
+    if(lines.empty() || SDL_GetTicks()-updated>=250) {
+        updated=SDL_GetTicks();
+        lines.clear();
+        char line[128];
+        sprintf(line,"%-8s %6s %6s %6s","ms","min","avg","p99");
+        lines.push_back(line);
+        for(int i=0;i<Profiler::PHASES;i++) {
+            sprintf(line,"%-8s %6.2f %6.2f %6.2f",Profiler::returnName(i),profiler.returnMin(i),profiler.returnAverage(i),profiler.returnP99(i));
+            lines.push_back(line);
+        }
+        sprintf(line,"draws %d  switches %d",profiler.returnDraws(),profiler.returnSwitches());
+        lines.push_back(line);
+        sprintf(line,"tick %.2f ms  dropped %u",ticker.returnTickTime(),(unsigned)ticker.returnDropped());
+        lines.push_back(line);
     }
-    return tile.returnName();
-}
-
-void create_map_layers(Texture &layers, Texture &minimap, Terrain_Resources &Terrain_Resource, Mouse_Resources &Mouse_Resource,std::map<std::string,std::vector<Texture> > textures,std::map<std::string,Tile> tiles) {
-    SDL_SetRenderDrawColor(Renderer,0,0,0,255);
-    minimap.createBlank(Renderer,(50*50+25)/5,(50*28+12)/5,SDL_TEXTUREACCESS_TARGET);
-    layers.createBlank(Renderer,(50*50+25),(50*28+12),SDL_TEXTUREACCESS_TARGET);
-    std::string name; Tile tile; int placex, placey, level;
-    SDL_Rect l = {0,0,50*50+25,50*28+12};
-    layers.setAsRenderTarget(Renderer);
-    SDL_RenderFillRect(Renderer,&l);
-    l.w=l.w/5;
-    l.h=l.h/5;
-    for(int i=0;i<Terrain_Resource.terrain_individual_information.size();i++) {
-        name=Terrain_Resource.terrain_individual_information[i].returnName();
-        tile=Terrain_Resource.terrain_individual_information[i];
-        level=tile.returnLevel()*10;
-        placex=tile.returnX()+Mouse_Resource.x_modifier;
-        placey=tile.returnY()+Mouse_Resource.y_modifier+Terrain_Resource.height-textures.find(name)->second[tile.returnIndex()].getHeight();
-        textures.find(name)->second[tile.returnIndex()].render(Renderer,placex,placey);
+    SDL_Color yellow={255,255,0,255};
+    for(int i=0;i<(int)lines.size();i++) {
+        font.draw(batch,lines[i],x,y+i*font.returnHeight(),yellow);
     }
-    minimap.setAsRenderTarget(Renderer);
-    SDL_RenderFillRect(Renderer,&l);
-    SDL_Rect rect = {0,0,(50*50+25)/5,(50*28+12)/5};
-    layers.renderRect(Renderer,&rect,NULL);
-    SDL_SetRenderTarget(Renderer,NULL);
-    SDL_SetRenderDrawColor(Renderer,255,255,255,255);
 }
 
 int main(int argc, char* args[]) {
     Mouse_Resources Mouse_Resource;
     Terrain_Resources Terrain_Resource;
-    std::map<std::string,std::vector<Texture> > textures;
+    Atlas atlas; //every terrain and ui sprite
+    SpriteBatch batch; //the frame, queued and then drawn by one flush
+    SpriteBatch baking; //chunks are baked with their own batch while the frame's is queuing
+    Font font; //header and label text
     std::map<std::string,Tile> tiles;
-    Texture minimap;
-    Texture layers;
-    srand(time(NULL));
-    if(!initConfig() && !initSDL() && !initWindow() && !initTextures(textures) && !initTiles(tiles)) {//Loads basic settings
-        std::cerr<<"Failed to initialize config!\n";
+    Minimap minimap;
+    ChunkCache layers;
+    Simulation sim;
+    SimThread ticker; //runs sim apart from the render loop, stopped before sim goes
+    ThreadPool pool; //worker threads for loading and anything else that runs in parallel
+    Startup_Resources Startup;
+    initStartup(Startup,pool,tiles,atlas,Terrain_Resource);
+    if(!Startup.config) {//Loads basic settings, the defaults are used without them
+        std::cerr<<"Failed to load config, using the defaults!\n";
+    }
+    if(!Startup.sdl) {//Initializes SDL and related libraries
+        std::cerr<<"Failed to initialize SDL!\n";
     }
     else {
-        if(!initSDL() && !initWindow()) {//Initializes SDL and related libraries
-            std::cerr<<"Failed to initialize SDL!\n";
+        if(!Startup.window) { //Creates a window
+            std::cerr<<"Failed to initialize window!\n";
         }
         else {
-            if(!initWindow()) { //Creates a window
-                std::cerr<<"Failed to initialize window!\n";
+            if(!Startup.textures) { //Loads all textures
+                std::cerr<<"Failed to load textures!\n";
             }
             else {
-                if(!initTextures(textures)) { //Loads all textures
-                    std::cerr<<"Failed to load textures!\n";
+                if(!Startup.tiles) {
+                    std::cerr<<"Failed to load tiles!\n";
+                }
+                else if(!Startup.map) {
+                    std::cerr<<"Failed to load map!\n";
                 }
                 else {
-                    if(!initTiles(tiles)) {
-                        std::cerr<<"Failed to load tiles!\n";
+                    //Cursor Initialization
+                    SDL_Cursor* cursor;
+                    cursor=init_system_cursor(arrow);
+                    SDL_SetCursor(cursor);
+
+                    //Map Initialization
+                    layers.init(Terrain_Resource.world_width,Terrain_Resource.world_height,512,[&](SDL_Renderer* Renderer, SDL_Rect area, int scale) {
+                        bake_map_region(Renderer,area,scale,Terrain_Resource,atlas,baking);
+                    });
+                    if(!build_minimap(minimap,Terrain_Resource,pool) || !minimap.upload(Renderer)) {
+                        std::cerr<<"Failed to build minimap!\n";
                     }
-                    else {
-                        //Cursor Initialization
-                        SDL_Cursor* cursor;
-                        cursor=init_system_cursor(arrow);
-                        SDL_SetCursor(cursor);
-
-                        //Map Initialization
-                        map_parse(tiles, Terrain_Resource.terrain_individual_information,"..//Settlements//map.map",textures);
-                        create_map_layers(layers, minimap,Terrain_Resource,Mouse_Resource,textures,tiles);
-
-                        //Event Initialization
-                        const Uint8* currentKeyStates;
-                        //initiates end of event loop
-                        SDL_Event e; //event value
-
-                        //keyboard logic
-                        bool QUIT = false;
-
-                        //Viewport Initialization
-                        SDL_Rect screen={0,0,SCREEN_WIDTH,SCREEN_HEIGHT}; //the main screen viewport
-                        SDL_Rect header={0,0,SCREEN_WIDTH,30}; //the header menu viewport
-                        SDL_Rect header_highlight={0,0,SCREEN_WIDTH,29}; //the header highlights viewport
-                        SDL_Rect map={0,30,SCREEN_WIDTH,SCREEN_HEIGHT-30}; //viewport for map area
-
-                        SDL_Rect srcrect;
-                        SDL_Rect dsrect;
-
-                        //Window Initializations
-                        Window Map(Renderer,0,screen.h-250, 380, 250);
-                        SDL_Rect window0_rect;
-                        SDL_Rect minimap_selector;
-
-
-                        std::vector<Checkbox> window01;
-                        window01.push_back(Checkbox(Renderer,"hex",22,21));
-                        window01.push_back(Checkbox(Renderer,"layer",22,63));
-
-                        std::vector<Button> window0;
-                        window0.push_back(Button(Renderer,"cardinalarrow",22,0,0));
-                        window0.push_back(Button(Renderer,"cardinalarrow",43,21,90));
-                        window0.push_back(Button(Renderer,"cardinalarrow",22,42,180));
-                        window0.push_back(Button(Renderer,"cardinalarrow",1,21,270));
-                        window0.push_back(Button(Renderer,"diagonalarrow",1,0,270));
-                        window0.push_back(Button(Renderer,"diagonalarrow",43,0,0));
-                        window0.push_back(Button(Renderer,"diagonalarrow",43,42,90));
-                        window0.push_back(Button(Renderer,"diagonalarrow",1,42,180));
-
-                        int placex=0;int placey=0;
-                        Uint32 startTime;
-                        Uint32 endTime;
-                        int left=0, right=0;
-
-                        while(!QUIT) {
-                            startTime = SDL_GetTicks();
-
+                    sim.attach(Terrain_Resource.terrain,Terrain_Resource.types);
+                    sim.populate(SETTLEMENTS,Terrain_Resource.seed,50);
+                    ticker.start(sim,TICK_MS);
+                    font.load(Renderer,"../Settlements/assets/ttf/default.ttf",14);
+                    Font small; //profiler overlay
+                    small.load(Renderer,"../Settlements/assets/ttf/default.ttf",12);
+                    printf("%d textures resident, about %.1f MB of video memory\n",TextureCache::instance().returnResident(),TextureCache::instance().returnBytes()/1048576.0);
+
+                    //Event Initialization
+                    const Uint8* currentKeyStates;
+                    //initiates end of event loop
+                    SDL_Event e; //event value
+
+                    //keyboard logic
+                    bool QUIT = false;
+
+                    //Viewport Initialization
+                    SDL_Rect screen={0,0,SCREEN_WIDTH,SCREEN_HEIGHT}; //the main screen viewport
+                    SDL_Rect header={0,0,SCREEN_WIDTH,30}; //the header menu viewport
+                    SDL_Rect header_highlight={0,0,SCREEN_WIDTH,29}; //the header highlights viewport
+                    SDL_Rect map={0,30,SCREEN_WIDTH,SCREEN_HEIGHT-30}; //viewport for map area
+
+                    SDL_Rect camera; //part of the map in view
+
+                    //Window Initializations
+                    Window Map(Renderer,0,screen.h-250, 380, 250);
+
+                    //The Map window shows the minimap left of a strip of buttons
+                    Map.setStrip(64);
+                    Map.addCheckbox(Checkbox(atlas,"hex",22,21));
+                    Map.addCheckbox(Checkbox(atlas,"layer",22,63));
+                    Map.addButton(Button(atlas,"cardinalarrow",22,0,0));
+                    Map.addButton(Button(atlas,"cardinalarrow",43,21,90));
+                    Map.addButton(Button(atlas,"cardinalarrow",22,42,180));
+                    Map.addButton(Button(atlas,"cardinalarrow",1,21,270));
+                    Map.addButton(Button(atlas,"diagonalarrow",1,0,270));
+                    Map.addButton(Button(atlas,"diagonalarrow",43,0,0));
+                    Map.addButton(Button(atlas,"diagonalarrow",43,42,90));
+                    Map.addButton(Button(atlas,"diagonalarrow",1,42,180));
+                    Map.setContent([&](SpriteBatch &window_batch, SDL_Rect pane) { //the finest minimap level that fits
+                        minimap.render(window_batch,minimap.choose(pane.w,pane.h),pane,camera);
+                    });
+                    EventRouter router; //sends mouse events to the widget under the mouse
+                    router.init(SCREEN_WIDTH,SCREEN_HEIGHT);
+                    Map.attach(router);
+
+                    int left=0, right=0;
+                    Profiler &profiler=Profiler::instance();
+                    Uint32 last_frame=SDL_GetTicks();
+                    std::shared_ptr<const Simulation::Snapshot> before, after; //the last two simulation snapshots, drawn between
+                    RenderScheduler scheduler;
+                    if(!scheduler.init(Renderer,SCREEN_WIDTH,SCREEN_HEIGHT)) {
+                        std::cerr<<"Failed to create the frame target!\n";
+                    }
+                    std::string header_text; //what the header shows, it is drawn again when this changes
+                    Uint32 profile_drawn=0;
+                    Uint32 terrain_due=0; //when an animated tile in view next changes, 0 if none is
+                    //Layers of the frame's batch. The map is layer 0, or a layer per row when every tile is queued.
+                    const int HEADER_LAYER=std::max(Terrain_Resource.rows,1), WINDOW_LAYER=HEADER_LAYER+1, OVERLAY_LAYER=HEADER_LAYER+2;
+
+                    while(!QUIT) {
+                        //Nothing damaged and no input, sleep until there is. The time asleep doesn't scroll the camera.
+                        if(scheduler.wait()) {
+                            last_frame=SDL_GetTicks();
+                        }
+                        profiler.beginFrame();
+                        Uint32 now=SDL_GetTicks();
+                        float seconds=std::min((now-last_frame)/1000.0f,0.25f); //a stall doesn't throw the camera across the map
+                        last_frame=now;
+                        int camera_x=Mouse_Resource.x_modifier, camera_y=Mouse_Resource.y_modifier;
+                        float camera_zoom=Mouse_Resource.zoom;
+                        SDL_Rect panel=Map.returnRect();
+                        bool panel_hidden=Map.returnHide();
+
+                        {
+                            ProfileScope scope(Profiler::PICKING);
                             SDL_GetMouseState(&Mouse_Resource.x,&Mouse_Resource.y);
-                            GetMouseLocation(Mouse_Resource,Terrain_Resource.width, Terrain_Resource.height, Terrain_Resource.terrain_individual_information,left,right);
-                            UpdateCamera(Mouse_Resource);
+                            GetMouseLocation(Mouse_Resource,Terrain_Resource.picker,Terrain_Resource.terrain,left,right);
+                        }
+                        {
+                            ProfileScope scope(Profiler::CAMERA);
+                            if(UpdateCamera(Mouse_Resource,Terrain_Resource,seconds,SCREEN_WIDTH,SCREEN_HEIGHT)) {
+                                scheduler.wakeAt(now+4); //keeps scrolling while the mouse stays at the edge
+                            }
+                        }
 
-                            while(SDL_PollEvent(&e)!=0) {
-                                currentKeyStates=SDL_GetKeyboardState( NULL );
-                                if(e.type==SDL_QUIT) {
-                                    QUIT = true;
-                                }
-                                Map.handleEvent(&e);
-                                for(int i=0; i<window01.size();i++) {
-                                    window01[i].handleEvent(&e);
+                        profiler.begin(Profiler::EVENTS);
+                        while(SDL_PollEvent(&e)!=0) {
+                            currentKeyStates=SDL_GetKeyboardState( NULL );
+                            if(e.type==SDL_QUIT) {
+                                QUIT = true;
+                            }
+                            if(e.type==SDL_WINDOWEVENT) { //Shown, exposed or restored, the window may have lost what was on it
+                                scheduler.damageAll();
+                            }
+                            if(e.type==SDL_KEYDOWN && e.key.repeat==0) {
+                                if(e.key.keysym.sym==SDLK_F3) { //Toggles the profiler overlay
+                                    PROFILE=!PROFILE;
+                                    scheduler.damage(map);
                                 }
-                                for(int i=0; i<window0.size();i++) {
-                                    window0[i].handleEvent(&e);
+                                else if(e.key.keysym.sym==SDLK_F12) { //Writes the profiler history to PROFILE_CSV
+                                    profiler.dump(PROFILE_CSV);
                                 }
                             }
-                            //Clear screen
-                            SDL_RenderClear(Renderer);
-
-                            //Map Viewport
-                            SDL_RenderSetViewport(Renderer,&map); {
-                                srcrect={srcrect.x-=Mouse_Resource.x_modifier, srcrect.y-=Mouse_Resource.y_modifier,map.w,map.h};
-                                dsrect={map.x,0,map.w,map.h};
-                                layers.renderRect(Renderer,&dsrect,&srcrect);
-                                if(left!=-1 && right!=-1) {
-                                    placex=Mouse_Resource.tile_location_x+(Mouse_Resource.x_modifier);
-                                    placey=Mouse_Resource.tile_location_y+(Mouse_Resource.y_modifier);
-                                    //textures.find("lcursor")->second[left].render(Renderer, placex, placey);
-                                    //textures.find("rcursor")->second[right].render(Renderer, placex, placey);
-                                }
+                            bool taken=router.dispatch(&e); //mouse events no widget took are for the map
+                            if(e.type==SDL_MOUSEWHEEL && !taken) { //Zooms the map around the mouse
+                                ZoomCamera(Mouse_Resource,Terrain_Resource,e.wheel.y,SCREEN_WIDTH,SCREEN_HEIGHT);
                             }
-
-                            //Screen Viewport
-                            SDL_RenderSetViewport(Renderer, &screen); {
-                                Map.render(Renderer);
-                                window0_rect=Map.returnUsuableViewport();
+                            //In the editor, right clicking a tile turns it into the next tile type
+                            if(EDITOR && e.type==SDL_MOUSEBUTTONDOWN && e.button.button==SDL_BUTTON_RIGHT && !taken && Mouse_Resource.y>=30 && Mouse_Resource.column!=-1) {
+                                int type=Terrain_Resource.terrain.returnType(Mouse_Resource.column,Mouse_Resource.row);
+                                change_tile(Terrain_Resource,Mouse_Resource.column,Mouse_Resource.row,(type+1)%Terrain_Resource.types.returnCount());
                             }
-                            SDL_RenderSetViewport(Renderer,&window0_rect); {
-                                minimap_selector={-Mouse_Resource.x_modifier/5,-Mouse_Resource.y_modifier/5,map.w/5,map.h/5};
-
-                                srcrect={0,0,window0_rect.w,window0_rect.h};
-                                dsrect={0,0,srcrect.w,srcrect.h};
-
-                                if(minimap_selector.x+minimap_selector.w>window0_rect.w-64) {
-                                    srcrect.x=minimap_selector.x+minimap_selector.w-window0_rect.w+64;
-                                    minimap_selector.x-=srcrect.x;
-                                }
+                        }
+                        profiler.end(Profiler::EVENTS);
+                        if(!Terrain_Resource.changed.empty()) {
+                            for(int i=0;i<(int)Terrain_Resource.changed.size();i++) {
+                                ticker.edit(Terrain_Resource.changed[i],Terrain_Resource.terrain.returnType(Terrain_Resource.changed[i]));
+                            }
+                            redraw_changed_tiles(Renderer,Terrain_Resource,layers,minimap);
+                            scheduler.damage(map);
+                            Map.invalidate();
+                        }
+                        {
+                            ProfileScope scope(Profiler::SIMULATION);
+                            ticker.view(before,after);
+                        }
+                        //The layer checkbox shows the ground under hills, forests and mountains
+                        int view_level=Map.returnCheckbox(1).getState() ? 1 : TileDatabase::LEVELS-1;
+                        if(view_level!=Terrain_Resource.view_level) {
+                            Terrain_Resource.view_level=view_level;
+                            layers.clear();
+                            scheduler.damage(map);
+                        }
 
+                        //Damage from this frame's changes
+                        if(Mouse_Resource.x_modifier!=camera_x || Mouse_Resource.y_modifier!=camera_y || Mouse_Resource.zoom!=camera_zoom) {
+                            scheduler.damage(map);
+                            Map.invalidate(); //the minimap shows the camera
+                        }
+                        SDL_Rect panel_now=Map.returnRect();
+                        if(!SDL_RectEquals(&panel,&panel_now) || panel_hidden!=Map.returnHide()) {
+                            scheduler.damage(panel);
+                            scheduler.damage(panel_now);
+                        }
+                        if(Map.returnStale()) {
+                            scheduler.damage(panel_now);
+                        }
+                        std::string text;
+                        if(Terrain_Resource.terrain.contains(Mouse_Resource.column,Mouse_Resource.row)) {
+                            int type=Terrain_Resource.terrain.returnType(Mouse_Resource.column,Mouse_Resource.row);
+                            char position[64];
+                            sprintf(position," (%d, %d) level %d",Mouse_Resource.column,Mouse_Resource.row,Terrain_Resource.terrain.returnLevel(Mouse_Resource.column,Mouse_Resource.row));
+                            text=Terrain_Resource.types.returnName(type)+position;
+                            int settlement=after->owners->empty() ? -1 : (*after->owners)[Terrain_Resource.terrain.index(Mouse_Resource.column,Mouse_Resource.row)];
+                            if(settlement!=-1) {
+                                char people[64];
+                                sprintf(people,"  settlement of %d people",(int)SimThread::population(*before,*after,settlement,ticker.blend(*after,now)));
+                                text+=people;
+                                scheduler.wakeAt(now+33); //the population moves between snapshots
+                            }
+                        }
+                        if(text!=header_text) {
+                            header_text=text;
+                            scheduler.damage(header);
+                        }
+                        SDL_Rect overlay={map.x+map.w-240,map.y+6,240,(Profiler::PHASES+3)*small.returnHeight()};
+                        if(PROFILE) { //the overlay refreshes four times a second
+                            if(now-profile_drawn>=250) {
+                                scheduler.damage(overlay);
+                            }
+                            scheduler.wakeAt(profile_drawn+250);
+                        }
 
+                        if(terrain_due!=0) { //animated tiles are drawn again when they change
+                            if((Sint32)(now-terrain_due)>=0) {
+                                scheduler.damage(map);
+                            }
+                            else {
+                                scheduler.wakeAt(terrain_due);
+                            }
+                        }
 
-                                minimap.renderRect(Renderer,&dsrect,&srcrect);
+                        camera={-Mouse_Resource.x_modifier,-Mouse_Resource.y_modifier,(int)(map.w/Mouse_Resource.zoom),(int)(map.h/Mouse_Resource.zoom)};
 
-                                SDL_RenderDrawRect(Renderer,&minimap_selector);
+                        //Only the damaged part of the frame is drawn, nothing at all when nothing changed. Everything is
+                        //queued in batch by layer and drawn with one flush in present().
+                        if(!scheduler.begin(Renderer,batch)) {
+                            profiler.endFrame(); //the events and the simulation of an idle frame still count
+                            continue;
+                        }
 
-                                window0_rect.x-=64;
-                                window0_rect.x+=window0_rect.w;
-                                window0_rect.w=64;
+                        //Map Viewport
+                        profiler.begin(Profiler::MAP);
+                        batch.setLayer(0,false);
+                        if(scheduler.clip(batch,map)) {
+                            //Zoomed out too far to see the animation, the chunks are cheaper than drawing every tile
+                            if(ANIMATE_TERRAIN && ChunkCache::chooseLevel(Mouse_Resource.zoom)==0) {
+                                terrain_due=queue_map_view(camera,Mouse_Resource.zoom,now,Terrain_Resource,atlas,batch);
                             }
-
-                            SDL_RenderSetViewport(Renderer,&window0_rect); {
-                                SDL_SetRenderDrawColor(Renderer, 0,0,0,255);
-                                SDL_RenderFillRect(Renderer,NULL);
-                                SDL_SetRenderDrawColor(Renderer, 255,255, 255, 255);
-                                for(int i=0; i<window01.size();i++) {
-                                    window01[i].setRenderRect(window0_rect);
-                                }
-                                for(int i=0; i<window0.size();i++) {
-                                    window0[i].setRenderRect(window0_rect);
-                                }
-                                for(int i=0; i<window01.size();i++) {
-                                    window01[i].render(Renderer);
-                                }
-                                for(int i=0; i<window0.size();i++) {
-                                    window0[i].render(Renderer);
-                                }
+                            else {
+                                layers.render(Renderer,batch,camera,Mouse_Resource.zoom);
+                                terrain_due=0;
                             }
-
-                            SDL_RenderPresent(Renderer);
-                            endTime=SDL_GetTicks();
-                            if(endTime-startTime>0) {
-                                std::cout << 1000/(endTime-startTime) << " ";
+                        }
+                        profiler.end(Profiler::MAP);
+
+                        profiler.begin(Profiler::WINDOWS);
+
+                        //Header Viewport
+                        batch.setLayer(HEADER_LAYER);
+                        if(scheduler.clip(batch,header)) {
+                            SDL_Color white={255,255,255,255}, black={0,0,0,255};
+                            SDL_Rect bar={0,0,header.w,header.h};
+                            batch.addRect(bar,black);
+                            if(!header_text.empty()) {
+                                font.draw(batch,header_text,6,(header.h-font.returnHeight())/2,white);
                             }
                         }
+
+                        //Screen Viewport
+                        batch.setLayer(WINDOW_LAYER);
+                        if(scheduler.clip(batch,screen)) {
+                            Map.render(Renderer,batch);
+                        }
+
+                        batch.setLayer(OVERLAY_LAYER);
+                        if(PROFILE && scheduler.clip(batch,map)) {
+                            render_profile(batch,small,ticker,map.w-240,6);
+                            profile_drawn=now;
+                        }
+                        profiler.end(Profiler::WINDOWS);
+
+                        {
+                            ProfileScope scope(Profiler::PRESENT); //the whole frame's draw calls and the present
+                            scheduler.present(Renderer,batch);
+                        }
+                        profiler.endFrame();
+                    }
+                    ticker.stop();
+                    if(PROFILE) {
+                        profiler.dump(PROFILE_CSV);
                     }
+                    small.free();
                 }
             }
         }
+    }
     //Free resources and close SDL2
+    layers.clear();
+    minimap.free();
+    font.free();
+    atlas.free();
     close();
     return 0;
-    }
 }
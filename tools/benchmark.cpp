@@ -0,0 +1,392 @@
+//Headless benchmark of the map pipeline. Runs the game's own map functions on generated maps under SDL's dummy
+//video driver with a software renderer drawing into an offscreen surface, so it needs no display or GPU.
+//Usage: benchmark [--csv] [output file]
+//Build on Linux with make -C tools benchmark (see tools/Makefile), on Windows with the Benchmark target of SDLTest.cbp.
+//Results are JSON (or CSV) with the time and the number of heap allocations of every step.
+
+#include <SDL2/SDL.h>
+#include <SDL2/SDL_image.h>
+#include <iostream>
+#include <string>
+#include <fstream>
+#include <sstream>
+#include <vector>
+#include <map>
+#include <algorithm>
+#include <functional>
+#include <deque>
+#include <stdint.h>
+#include <stdlib.h>
+#include <memory>
+#include <new>
+
+#include <boost/filesystem.hpp>
+
+#include "../framework/core/threadpool.h"
+#include "../framework/render/texturecache.h"
+#include "../framework/render/atlas.h"
+#include "../framework/render/spritebatch.h"
+#include "../framework/interface/texture.h"
+#include "../framework/interface/tile.h"
+#include "../framework/interface/eventrouter.h"
+#include "../framework/terrain/chunkcache.h"
+#include "../framework/terrain/terraingrid.h"
+#include "../framework/terrain/tiledatabase.h"
+#include "../framework/terrain/mapfile.h"
+#include "../framework/terrain/picking.h"
+#include "../framework/terrain/minimap.h"
+#include "../framework/terrain/worldgen.h"
+#include "../framework/terrain/pathfinder.h"
+#include "../framework/terrain/flowfield.h"
+#include "../framework/terrain/world.h"
+#include "../framework/sim/simulation.h"
+
+//---------Allocation_Counting------------------------
+
+SDL_atomic_t allocations; //every operator new since the start
+SDL_atomic_t allocated_bytes;
+
+void* operator new(size_t size) {
+    SDL_AtomicAdd(&allocations,1);
+    SDL_AtomicAdd(&allocated_bytes,(int)size);
+    void* memory=malloc(size>0 ? size : 1);
+    if(memory==NULL) {
+        throw std::bad_alloc();
+    }
+    return memory;
+}
+
+void* operator new[](size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* memory) noexcept {
+    free(memory);
+}
+
+void operator delete[](void* memory) noexcept {
+    free(memory);
+}
+
+//---------Measuring------------------------
+
+struct Benchmark_Result {
+    std::string name;
+    int size; //map is size*size tiles, 0 if the step doesn't depend on the map
+    int iterations;
+    double total_ms, min_ms, max_ms;
+    long allocations, bytes; //per iteration
+};
+
+std::vector<Benchmark_Result> results;
+
+//Runs job iterations times and records the time and allocations of each run
+
+void measure(std::string name, int size, int iterations, std::function<void(int)> job) {
+    Benchmark_Result result={name,size,iterations,0,1e30,0,0,0};
+    Uint64 frequency=SDL_GetPerformanceFrequency();
+    int first_allocations=SDL_AtomicGet(&allocations);
+    int first_bytes=SDL_AtomicGet(&allocated_bytes);
+    for(int i=0;i<iterations;i++) {
+        Uint64 start=SDL_GetPerformanceCounter();
+        job(i);
+        double ms=(SDL_GetPerformanceCounter()-start)*1000.0/frequency;
+        result.total_ms+=ms;
+        result.min_ms=std::min(result.min_ms,ms);
+        result.max_ms=std::max(result.max_ms,ms);
+    }
+    //The counters wrap around, the difference is still right as long as a step stays under 4 GB
+    result.allocations=(long)((unsigned int)SDL_AtomicGet(&allocations)-(unsigned int)first_allocations)/iterations;
+    result.bytes=(long)((unsigned int)SDL_AtomicGet(&allocated_bytes)-(unsigned int)first_bytes)/iterations;
+    results.push_back(result);
+    fprintf(stderr,"%-16s %5d  %10.3f ms  %8ld allocations\n",name.c_str(),size,result.total_ms/iterations,result.allocations);
+}
+
+void write_results(std::ostream &out, bool csv) {
+    if(csv) {
+        out<<"name,size,iterations,mean_ms,min_ms,max_ms,allocations,bytes\n";
+        for(int i=0;i<(int)results.size();i++) {
+            Benchmark_Result &r=results[i];
+            out<<r.name<<","<<r.size<<","<<r.iterations<<","<<r.total_ms/r.iterations<<","<<r.min_ms<<","<<r.max_ms<<","<<r.allocations<<","<<r.bytes<<"\n";
+        }
+        return;
+    }
+    out<<"[\n";
+    for(int i=0;i<(int)results.size();i++) {
+        Benchmark_Result &r=results[i];
+        out<<"  {\"name\": \""<<r.name<<"\", \"size\": "<<r.size<<", \"iterations\": "<<r.iterations;
+        out<<", \"mean_ms\": "<<r.total_ms/r.iterations<<", \"min_ms\": "<<r.min_ms<<", \"max_ms\": "<<r.max_ms;
+        out<<", \"allocations\": "<<r.allocations<<", \"bytes\": "<<r.bytes<<"}"<<(i+1<(int)results.size() ? "," : "")<<"\n";
+    }
+    out<<"]\n";
+}
+
+//---------Benchmark------------------------
+
+int main(int argc, char* args[]) {
+    bool csv=false;
+    std::string output;
+    for(int i=1;i<argc;i++) {
+        if(std::string(args[i])=="--csv") {
+            csv=true;
+        }
+        else {
+            output=args[i];
+        }
+    }
+
+    //Dummy video driver and a software renderer into a surface, nothing is shown
+    SDL_setenv("SDL_VIDEODRIVER","dummy",1);
+    if(SDL_Init(SDL_INIT_VIDEO)<0) {
+        printf( "SDL could not initialize! SDL Error: %s\n", SDL_GetError() );
+        return 1;
+    }
+    if(!(IMG_Init(IMG_INIT_PNG)&IMG_INIT_PNG)) {
+        printf( "SDL_image could not initialize! SDL_image Error: %s\n", IMG_GetError());
+        return 1;
+    }
+    const int screen_width=1280, screen_height=800;
+    SDL_Surface* screen=SDL_CreateRGBSurfaceWithFormat(0,screen_width,screen_height,32,SDL_PIXELFORMAT_ARGB8888);
+    SDL_Renderer* Renderer=screen!=NULL ? SDL_CreateSoftwareRenderer(screen) : NULL;
+    if(Renderer==NULL) {
+        printf( "Renderer could not be created! SDL Error: %s\n", SDL_GetError() );
+        return 1;
+    }
+    int result=0;
+    {
+        Atlas atlas;
+        SpriteBatch batch;
+        ThreadPool pool;
+        std::vector<Texture_File> files;
+        scan_textures("../Settlements/assets/textures","",atlas,files);
+        for(int i=0;i<(int)files.size();i++) {
+            SDL_Surface* surface=IMG_Load(files[i].path.c_str());
+            if(surface!=NULL) {
+                atlas.setSurface(files[i].group,files[i].variant,surface);
+            }
+        }
+        std::map<std::string,Tile> tiles;
+        Terrain_Resources Terrain_Resource;
+        if(files.empty() || !atlas.pack() || !atlas.upload(Renderer)) {
+            printf("Failed to load textures!\n");
+            result=1;
+        }
+        else if(!initTiles(tiles) || !compile_tile_types(tiles,Terrain_Resource,atlas)) {
+            printf("Failed to load tiles!\n");
+            result=1;
+        }
+        else {
+            measure_tile_types(Terrain_Resource,atlas);
+            measure("initTiles",0,20,[&](int) {
+                std::map<std::string,Tile> parsed;
+                initTiles(parsed);
+            });
+            //Mouse events through a dozen widgets and through hundreds, the grid should keep both the same
+            const int widget_counts[2]={12,512};
+            for(int w=0;w<2;w++) {
+                EventRouter router;
+                router.init(screen_width,screen_height);
+                for(int i=0;i<widget_counts[w];i++) {
+                    SDL_Rect rect={(i*37)%(screen_width-40),(i*53)%(screen_height-30),40,30};
+                    router.add(rect,[](SDL_Event*, int, int, bool) {});
+                }
+                SDL_Event motion;
+                motion.type=SDL_MOUSEMOTION;
+                measure("route_event",widget_counts[w],100000,[&](int) {
+                    router.dispatch(&motion);
+                });
+            }
+
+            boost::filesystem::path directory=boost::filesystem::temp_directory_path();
+            const int sizes[3]={50,500,2000};
+            for(int s=0;s<3;s++) {
+                int size=sizes[s];
+                int repeat=size<=50 ? 20 : size<=500 ? 3 : 1;
+                std::ostringstream name;
+                name<<"settlements_benchmark_"<<size;
+                std::string text_path=(directory/(name.str()+".map")).string();
+                std::string binary_path=(directory/(name.str()+".smap")).string();
+                //A noise generated world, with the mix of coasts, ranges and plains a real map has
+                TerrainGrid generated;
+                WorldGenerator generator(12345);
+                measure("generate",size,repeat,[&](int) {
+                    generator.generate(Terrain_Resource.types,size,size,pool,generated);
+                });
+                if(!MapFile::writeText(text_path,generated,Terrain_Resource.types) || !MapFile::write(binary_path,generated,Terrain_Resource.types,generator.returnSeed())) {
+                    result=1;
+                    break;
+                }
+
+                measure("map_parse_text",size,repeat,[&](int) {
+                    map_parse(Terrain_Resource,text_path);
+                });
+                measure("map_parse_binary",size,repeat,[&](int) {
+                    map_parse(Terrain_Resource,binary_path);
+                });
+
+                ChunkCache layers;
+                layers.init(Terrain_Resource.world_width,Terrain_Resource.world_height,512,[&](SDL_Renderer* Renderer, SDL_Rect area, int scale) {
+                    bake_map_region(Renderer,area,scale,Terrain_Resource,atlas,batch);
+                });
+                SDL_Rect map={0,30,screen_width,screen_height-30};
+                SDL_Rect camera={0,0,map.w,map.h};
+                SpriteBatch queued; //the frame's batch, apart from the one chunks are baked with
+                //Baking every chunk in view, what the first frame over a new part of the map costs
+                measure("bake_chunks",size,repeat,[&](int) {
+                    layers.clear();
+                    SDL_RenderSetViewport(Renderer,&map);
+                    layers.render(Renderer,queued,camera);
+                    queued.flush(Renderer);
+                });
+
+                //The minimap pyramid, rasterised from the tiles on the worker threads
+                Minimap minimap;
+                measure("build_minimap",size,repeat,[&](int) {
+                    build_minimap(minimap,Terrain_Resource,pool);
+                });
+                minimap.upload(Renderer);
+
+                //Editing one tile in view, which redraws only around it in the chunks and the minimap
+                measure("redraw_tile",size,100,[&](int i) {
+                    int column=std::min(10+i%10,size-1), row=std::min(10+i/10,size-1);
+                    int type=(Terrain_Resource.terrain.returnType(column,row)+1)%Terrain_Resource.types.returnCount();
+                    change_tile(Terrain_Resource,column,row,type);
+                    redraw_changed_tiles(Renderer,Terrain_Resource,layers,minimap);
+                });
+
+                Mouse_Resources Mouse_Resource;
+                int left, right;
+                measure("GetMouseLocation",size,100000,[&](int i) {
+                    Mouse_Resource.x=(i*37)%screen_width;
+                    Mouse_Resource.y=30+(i*53)%(screen_height-30);
+                    GetMouseLocation(Mouse_Resource,Terrain_Resource.picker,Terrain_Resource.terrain,left,right);
+                });
+
+                //Drag selecting a screen sized rectangle in the middle of the map
+                std::vector<int> selection;
+                measure("pickRect",size,100,[&](int) {
+                    SDL_Rect area={Terrain_Resource.world_width/2-map.w/2,Terrain_Resource.world_height/2-map.h/2,map.w,map.h};
+                    Terrain_Resource.picker.pickRect(Terrain_Resource.terrain,area,selection);
+                });
+
+                //The work of one frame of the main loop while the camera pans across the map
+                SDL_Rect screen_rect={0,0,screen_width,screen_height};
+                bool animated=false; //draws the tiles in view in place of the chunks
+                std::function<void(int)> frame=[&](int i) {
+                    GetMouseLocation(Mouse_Resource,Terrain_Resource.picker,Terrain_Resource.terrain,left,right);
+                    UpdateCamera(Mouse_Resource,Terrain_Resource,1/60.0f,screen_width,screen_height);
+                    SDL_RenderSetViewport(Renderer,&screen_rect);
+                    SDL_RenderClear(Renderer);
+                    queued.setViewport(&map);
+                    camera={-Mouse_Resource.x_modifier,-Mouse_Resource.y_modifier,(int)(map.w/Mouse_Resource.zoom),(int)(map.h/Mouse_Resource.zoom)};
+                    queued.setLayer(0,false);
+                    if(animated) {
+                        queue_map_view(camera,Mouse_Resource.zoom,i*16,Terrain_Resource,atlas,queued);
+                    }
+                    else {
+                        layers.render(Renderer,queued,camera,Mouse_Resource.zoom);
+                    }
+                    SDL_Rect pane={1,screen_height-244,316,244};
+                    queued.setLayer(std::max(Terrain_Resource.rows,1));
+                    queued.setViewport(NULL);
+                    minimap.render(queued,minimap.choose(pane.w,pane.h),pane,camera);
+                    queued.flush(Renderer);
+                    SDL_RenderPresent(Renderer);
+                };
+                Mouse_Resource.x=screen_width-5;
+                Mouse_Resource.y=screen_height/2;
+                Mouse_Resource.x_modifier=0;
+                Mouse_Resource.y_modifier=-Terrain_Resource.world_height/2;
+                measure("frame",size,240,frame);
+                //Every tile in view drawn each frame with the oceans animating, which should cost the same on every map size
+                animated=true;
+                measure("frame_animated",size,240,frame);
+                animated=false;
+                Mouse_Resource.x_modifier=0;
+                Mouse_Resource.y_modifier=-Terrain_Resource.world_height/2;
+                //Zoomed all the way out, where the level of detail chunks should keep the frame as cheap
+                ZoomCamera(Mouse_Resource,Terrain_Resource,-40,screen_width,screen_height);
+                measure("frame_zoomed_out",size,240,frame);
+
+                //Routes between random tiles, one at a time over the tiles and in batches over the cluster graph
+                Pathfinder paths;
+                Pathfinder::Costs costs={50,10,2};
+                paths.attach(Terrain_Resource.terrain,costs);
+                measure("path_build",size,repeat,[&](int) {
+                    paths.build(pool);
+                });
+                std::vector<Pathfinder::Query> queries(256);
+                uint32_t state=size;
+                for(int i=0;i<(int)queries.size();i++) {
+                    state=state*1664525+1013904223;
+                    queries[i].from=(state>>8)%Terrain_Resource.terrain.returnSize();
+                    state=state*1664525+1013904223;
+                    queries[i].to=(state>>8)%Terrain_Resource.terrain.returnSize();
+                }
+                Pathfinder::Search search;
+                measure("path",size,16,[&](int i) {
+                    paths.find(search,queries[i].from,queries[i].to,queries[i].path);
+                });
+                for(int i=0;i<(int)queries.size();i++) {
+                    queries[i].hierarchical=true;
+                }
+                measure("path_batch_256",size,repeat,[&](int) {
+                    paths.findBatch(queries,pool);
+                });
+
+                //Flow fields toward eight targets, then a tile edit repaired in all of them and units following one
+                FlowFields flows(8);
+                flows.attach(Terrain_Resource.terrain,paths);
+                std::vector<int> targets;
+                for(int i=0;i<8;i++) {
+                    targets.push_back(queries[i].to);
+                }
+                measure("flow_prepare_8",size,repeat,[&](int) {
+                    flows.clear();
+                    flows.prepare(targets,pool);
+                });
+                std::vector<int> changed(1);
+                measure("flow_repair",size,20,[&](int i) {
+                    int column=std::min(10+i,size-1), row=std::min(10+i,size-1);
+                    int type=(Terrain_Resource.terrain.returnType(column,row)+1)%Terrain_Resource.types.returnCount();
+                    change_tile(Terrain_Resource,column,row,type);
+                    changed[0]=Terrain_Resource.terrain.index(column,row);
+                    paths.update(changed[0]);
+                    flows.update(changed,pool);
+                });
+                Terrain_Resource.changed.clear();
+                int field=flows.acquire(targets[0]);
+                measure("flow_follow",size,100000,[&](int i) {
+                    flows.next(field,queries[i%queries.size()].from);
+                });
+
+                //One settlement every 25 tiles of land or water, ticked on the pool
+                Simulation sim;
+                sim.attach(Terrain_Resource.terrain,Terrain_Resource.types);
+                sim.populate(size*size/25,12345,50);
+                measure("sim_tick",size,repeat*10,[&](int) {
+                    sim.tick(pool);
+                });
+
+                layers.clear();
+                minimap.free();
+                boost::filesystem::remove(text_path);
+                boost::filesystem::remove(binary_path);
+            }
+        }
+        atlas.free();
+    }
+
+    if(output.empty()) {
+        write_results(std::cout,csv);
+    }
+    else {
+        std::ofstream out(output.c_str());
+        write_results(out,csv);
+    }
+    SDL_DestroyRenderer(Renderer);
+    SDL_FreeSurface(screen);
+    IMG_Quit();
+    SDL_Quit();
+    return result;
+}
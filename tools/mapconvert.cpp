@@ -0,0 +1,45 @@
+//Converts a text map (map.map) into a binary map that loads without parsing.
+//Usage: mapconvert <input map> <output map> [tiles file] [seed]
+
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../framework/interface/tile.h"
+#include "../framework/terrain/terraingrid.h"
+#include "../framework/terrain/tiledatabase.h"
+#include "../framework/terrain/mapfile.h"
+
+int main(int argc, char* args[]) {
+    if(argc<3) {
+        std::cerr<<"Usage: mapconvert <input map> <output map> [tiles file] [seed]\n";
+        return 1;
+    }
+    std::string tiles_path=argc>3 ? args[3] : "../Settlements/assets/tilesnew.txt";
+    uint32_t seed=argc>4 ? strtoul(args[4],NULL,10) : 0;
+
+    std::map<std::string,Tile> alltiles;
+    TileDatabase types;
+    if(!TileDatabase::parse(tiles_path,alltiles) || !types.compile(alltiles)) {
+        std::cerr<<"Failed to load tiles!\n";
+        return 1;
+    }
+    TerrainGrid grid;
+    if(MapFile::isBinary(args[1])) {
+        std::cerr<<args[1]<<" is already a binary map.\n";
+        return 1;
+    }
+    if(!MapFile::parseText(args[1],types,seed,grid)) {
+        std::cerr<<"Failed to read "<<args[1]<<"!\n";
+        return 1;
+    }
+    if(!MapFile::write(args[2],grid,types,seed)) {
+        std::cerr<<"Failed to write "<<args[2]<<"!\n";
+        return 1;
+    }
+    std::cout<<"Wrote "<<grid.returnColumns()<<"x"<<grid.returnRows()<<" map to "<<args[2]<<"\n";
+    return 0;
+}
@@ -0,0 +1,64 @@
+//Generates a world from a seed and writes it as a text or binary map.
+//Usage: mapgen <output map> <columns> <rows> [seed] [--text] [tiles file]
+
+#include <SDL2/SDL.h>
+#include <iostream>
+#include <string>
+#include <vector>
+#include <map>
+#include <functional>
+#include <deque>
+#include <stdint.h>
+#include <stdlib.h>
+
+#include "../framework/core/threadpool.h"
+#include "../framework/interface/tile.h"
+#include "../framework/terrain/terraingrid.h"
+#include "../framework/terrain/tiledatabase.h"
+#include "../framework/terrain/mapfile.h"
+#include "../framework/terrain/worldgen.h"
+
+int main(int argc, char* args[]) {
+    std::vector<std::string> positional;
+    bool text=false;
+    for(int i=1;i<argc;i++) {
+        if(std::string(args[i])=="--text") {
+            text=true;
+        }
+        else {
+            positional.push_back(args[i]);
+        }
+    }
+    if(positional.size()<3) {
+        std::cerr<<"Usage: mapgen <output map> <columns> <rows> [seed] [--text] [tiles file]\n";
+        return 1;
+    }
+    int columns=std::atoi(positional[1].c_str());
+    int rows=std::atoi(positional[2].c_str());
+    uint32_t seed=positional.size()>3 ? strtoul(positional[3].c_str(),NULL,10) : 0;
+    std::string tiles_path=positional.size()>4 ? positional[4] : "../Settlements/assets/tilesnew.txt";
+
+    std::map<std::string,Tile> alltiles;
+    TileDatabase types;
+    if(!TileDatabase::parse(tiles_path,alltiles) || !types.compile(alltiles)) {
+        std::cerr<<"Failed to load tiles!\n";
+        return 1;
+    }
+    TerrainGrid grid;
+    Uint64 start=SDL_GetPerformanceCounter();
+    {
+        ThreadPool pool;
+        if(!WorldGenerator(seed).generate(types,columns,rows,pool,grid)) {
+            std::cerr<<"Failed to generate the map!\n";
+            return 1;
+        }
+    }
+    double ms=(SDL_GetPerformanceCounter()-start)*1000.0/SDL_GetPerformanceFrequency();
+    bool written=text ? MapFile::writeText(positional[0],grid,types) : MapFile::write(positional[0],grid,types,seed);
+    if(!written) {
+        std::cerr<<"Failed to write "<<positional[0]<<"!\n";
+        return 1;
+    }
+    std::cout<<"Generated "<<columns<<"x"<<rows<<" map in "<<ms<<" ms, wrote it to "<<positional[0]<<"\n";
+    return 0;
+}